@@ -0,0 +1,239 @@
+/**     @file AsciiSTLReader.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Fast reader for ASCII STL files. The file is memory-mapped, split into
+  *     chunks on facet boundaries and the chunks are parsed in parallel.
+  *     Keywords are located with SSE2/AVX2 byte scans where available.
+  */
+
+#include "AsciiSTLReader.h"
+#include "TriangleSoup.h"
+
+#include <QFile>
+#include <vtkFloatArray.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STL_USE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Chunks smaller than this are not worth a thread of their own */
+static const qint64 minChunkSize = 4 * 1024 * 1024;
+
+/* Index of the lowest set bit of a non-zero mask */
+static inline int lowestBit(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/* Find the first occurrence of c in [p, end), returns end if not found.
+ * Compares 32 (AVX2) or 16 (SSE2) bytes at a time, the tail is scanned one byte at a time. */
+static const char* findChar(const char* p, const char* end, char c) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned int mask = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask)
+            return p + lowestBit(mask);
+        p += 32;
+    }
+#elif defined(STL_USE_SSE2)
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned int mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (mask)
+            return p + lowestBit(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != c)
+        p++;
+    return p;
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Find the next whole-word keyword in [p, end) that starts at or after p,
+ * first points to the start of the block so the character before a match can be checked.
+ * Returns end if not found. */
+static const char* findKeyword(const char* first, const char* p, const char* end, const char* keyword, size_t length) {
+    while (true) {
+        p = findChar(p, end, keyword[0]);
+        if (size_t(end - p) < length)
+            return end;
+        if (std::memcmp(p, keyword, length) == 0 && (p == first || isSpace(p[-1]))
+            && (size_t(end - p) == length || isSpace(p[length])))
+            return p;
+        p++;
+    }
+}
+
+/* Parse one float after optional white space, returns nullptr on failure */
+static const char* parseFloat(const char* p, const char* end, float& value) {
+    while (p < end && isSpace(*p))
+        p++;
+    if (p < end && *p == '+')
+        p++;
+
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+        return nullptr;
+    return result.ptr;
+}
+
+bool AsciiSTLReader::parseVertices(const char* begin, const char* end, std::vector<float>& coords) {
+    const char* p = begin;
+    while ((p = findKeyword(begin, p, end, "vertex", 6)) != end) {
+        p += 6;
+        for (int i = 0; i < 3; i++) {
+            float value;
+            p = parseFloat(p, end, value);
+            if (p == nullptr)
+                return false;
+            coords.push_back(value);
+        }
+    }
+    return true;
+}
+
+bool AsciiSTLReader::canRead(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray header = file.read(256).trimmed();
+    return header.startsWith("solid");
+}
+
+vtkSmartPointer<vtkPolyData> AsciiSTLReader::read(const QString& fileName, int chunks) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    qint64 size = file.size();
+    const char* text = reinterpret_cast<const char*>(file.map(0, size));
+    if (text == nullptr)
+        return nullptr;
+    const char* textEnd = text + size;
+
+    /* Skip the "solid <name>" line, the name is free text */
+    const char* body = findChar(text, textEnd, '\n');
+    if (body != textEnd)
+        body++;
+
+    /* Split the text into one chunk per thread, each chunk is moved forward to
+     * end just after an "endfacet" so no facet is split between two chunks */
+    if (chunks <= 0)
+        chunks = int(std::max<qint64>(1, std::min<qint64>(vtkSMPTools::GetEstimatedNumberOfThreads(), size / minChunkSize)));
+    std::vector<const char*> bounds(chunks + 1);
+    bounds[0] = body;
+    bounds[chunks] = textEnd;
+    for (qint64 i = 1; i < chunks; i++) {
+        const char* p = std::max(text + size * i / chunks, bounds[i - 1]);
+        p = findKeyword(body, p, textEnd, "endfacet", 8);
+        bounds[i] = (p == textEnd) ? textEnd : p + 8;
+    }
+
+    std::vector<std::vector<float>> parsed(chunks);
+    std::vector<char> ok(chunks, 1);
+    vtkSMPTools::For(0, chunks, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType i = first; i < last; i++) {
+            /* A typical vertex line is around 40 characters */
+            parsed[i].reserve(size_t(bounds[i + 1] - bounds[i]) / 40 * 3);
+            ok[i] = parseVertices(bounds[i], bounds[i + 1], parsed[i]);
+        }
+    });
+
+    /* Work out where each chunk's vertices go in the combined array */
+    std::vector<size_t> start(chunks + 1, 0);
+    for (qint64 i = 0; i < chunks; i++) {
+        if (!ok[i])
+            return nullptr;
+        start[i + 1] = start[i] + parsed[i].size();
+    }
+
+    size_t values = start[chunks];
+    if (values == 0 || values % 9 != 0)
+        return nullptr;
+
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(vtkIdType(values / 3));
+    float* points = coords->GetPointer(0);
+
+    vtkSMPTools::For(0, chunks, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType i = first; i < last; i++) {
+            std::copy(parsed[i].begin(), parsed[i].end(), points + start[i]);
+            std::vector<float>().swap(parsed[i]);
+        }
+    });
+
+    return TriangleSoup::build(coords);
+}
+
+vtkSmartPointer<vtkPolyData> AsciiSTLReader::readSampled(const QString& fileName, vtkIdType maxTriangles) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    qint64 size = file.size();
+    const char* text = reinterpret_cast<const char*>(file.map(0, size));
+    if (text == nullptr || maxTriangles <= 0)
+        return nullptr;
+    const char* textEnd = text + size;
+
+    const char* body = findChar(text, textEnd, '\n');
+    if (body != textEnd)
+        body++;
+
+    /* Jump to evenly spaced positions and parse the first whole facet after each.
+     * Positions that land in the same facet as the previous one are skipped,
+     * so small files give each facet once. */
+    std::vector<float> sampled;
+    sampled.reserve(size_t(9 * maxTriangles));
+    const char* last = body;
+    for (vtkIdType i = 0; i < maxTriangles; i++) {
+        const char* p = std::max(body + (textEnd - body) * i / maxTriangles, last);
+        const char* facet = findKeyword(body, p, textEnd, "facet", 5);
+        if (facet == textEnd)
+            break;
+        const char* facetEnd = findKeyword(body, facet, textEnd, "endfacet", 8);
+
+        std::vector<float> corners;
+        if (parseVertices(facet, facetEnd, corners) && corners.size() == 9)
+            sampled.insert(sampled.end(), corners.begin(), corners.end());
+
+        last = facetEnd;
+    }
+
+    if (sampled.empty())
+        return nullptr;
+
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(vtkIdType(sampled.size() / 3));
+    std::copy(sampled.begin(), sampled.end(), coords->GetPointer(0));
+
+    return TriangleSoup::build(coords);
+}
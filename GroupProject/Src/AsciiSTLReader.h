@@ -0,0 +1,55 @@
+/**     @file AsciiSTLReader.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Fast reader for ASCII STL files. The file is memory-mapped, split into
+  *     chunks on facet boundaries and the chunks are parsed in parallel.
+  *     Keywords are located with SSE2/AVX2 byte scans where available.
+  */
+
+#ifndef VIEWER_ASCIISTLREADER_H
+#define VIEWER_ASCIISTLREADER_H
+
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <vector>
+
+class AsciiSTLReader {
+public:
+    /** Check whether a file looks like an ASCII STL file (starts with "solid").
+      * Binary files should be checked for first, as some of them also start with "solid".
+      * @param fileName is the file to check
+      * @return true if the file can be read by this reader
+      */
+    static bool canRead(const QString& fileName);
+
+    /** Read an ASCII STL file.
+      * Every triangle gets its own three points, points are not merged.
+      * @param fileName is the file to read
+      * @param chunks is the number of chunks to split the file into, 0 to
+      *        pick one per thread for large files. Setting it lets tests put
+      *        chunk boundaries anywhere in small files.
+      * @return the geometry, or nullptr if the file could not be parsed
+      */
+    static vtkSmartPointer<vtkPolyData> read(const QString& fileName, int chunks = 0);
+
+    /** Read facets from evenly spaced positions in an ASCII STL file,
+      * to show as a cheap stand-in while the full file is loading.
+      * @param fileName is the file to read
+      * @param maxTriangles is the most triangles to return
+      * @return the sampled geometry, or nullptr if no facets could be parsed
+      */
+    static vtkSmartPointer<vtkPolyData> readSampled(const QString& fileName, vtkIdType maxTriangles);
+
+    /** Parse the vertex coordinates from a block of ASCII STL text.
+      * @param begin is the first character of the block
+      * @param end is one past the last character of the block
+      * @param coords receives 3 floats per vertex, appended in file order
+      * @return false if a vertex line could not be parsed
+      */
+    static bool parseVertices(const char* begin, const char* end, std::vector<float>& coords);
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**     @file BinarySTLReader.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Fast reader for binary STL files. The file is memory-mapped and the
+  *     triangle records are copied straight into the VTK point and cell
+  *     arrays, with large files split across threads.
+  */
+
+#include "BinarySTLReader.h"
+#include "TriangleSoup.h"
+
+#include <QFile>
+#include <vtkFloatArray.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/* Binary STL layout (little endian):
+ *   80 byte header
+ *   uint32 triangle count
+ *   per triangle: float normal[3], float vertex[3][3], uint16 attribute = 50 bytes
+ */
+static const qint64 headerSize = 84;
+static const qint64 recordSize = 50;
+
+/* Number of triangles handled by each thread, small files are read on one thread */
+static const vtkIdType grainSize = 65536;
+
+/* Read the triangle count and check it matches the file size */
+static bool triangleCount(const uchar* data, qint64 size, quint32& count) {
+    if (size < headerSize)
+        return false;
+
+    std::memcpy(&count, data + 80, sizeof(count));
+    return size == headerSize + recordSize * qint64(count);
+}
+
+bool BinarySTLReader::canRead(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray header = file.read(headerSize);
+    quint32 count;
+    return triangleCount(reinterpret_cast<const uchar*>(header.constData()), file.size(), count);
+}
+
+vtkSmartPointer<vtkPolyData> BinarySTLReader::read(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    qint64 size = file.size();
+    const uchar* data = file.map(0, size);
+    if (data == nullptr)
+        return nullptr;
+
+    quint32 count;
+    if (!triangleCount(data, size, count) || count == 0)
+        return nullptr;
+
+    vtkIdType triangles = count;
+    if (3 * triangles > VTK_TYPE_INT32_MAX)
+        return nullptr;
+
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(3 * triangles);
+    float* points = coords->GetPointer(0);
+
+    /* Each record holds the 9 vertex coordinates contiguously after the normal,
+     * so they can be copied as one block. The records are not 4 byte aligned
+     * hence memcpy rather than a float pointer. */
+    vtkSMPTools::For(0, triangles, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++) {
+            const uchar* record = data + headerSize + recordSize * t;
+            std::memcpy(points + 9 * t, record + 12, 9 * sizeof(float));
+        }
+    });
+
+    return TriangleSoup::build(coords);
+}
+
+vtkSmartPointer<vtkPolyData> BinarySTLReader::readSampled(const QString& fileName, vtkIdType maxTriangles) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    qint64 size = file.size();
+    const uchar* data = file.map(0, size);
+    if (data == nullptr)
+        return nullptr;
+
+    quint32 count;
+    if (!triangleCount(data, size, count) || count == 0 || maxTriangles <= 0)
+        return nullptr;
+
+    /* Only the sampled records are touched, so only their pages are read from disk */
+    vtkIdType step = std::max<vtkIdType>(1, (vtkIdType(count) + maxTriangles - 1) / maxTriangles);
+    vtkIdType triangles = (vtkIdType(count) + step - 1) / step;
+
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(3 * triangles);
+    float* points = coords->GetPointer(0);
+
+    for (vtkIdType t = 0; t < triangles; t++) {
+        const uchar* record = data + headerSize + recordSize * (t * step);
+        std::memcpy(points + 9 * t, record + 12, 9 * sizeof(float));
+    }
+
+    return TriangleSoup::build(coords);
+}
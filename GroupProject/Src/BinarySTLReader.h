@@ -0,0 +1,43 @@
+/**     @file BinarySTLReader.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Fast reader for binary STL files. The file is memory-mapped and the
+  *     triangle records are copied straight into the VTK point and cell
+  *     arrays, with large files split across threads.
+  */
+
+#ifndef VIEWER_BINARYSTLREADER_H
+#define VIEWER_BINARYSTLREADER_H
+
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class BinarySTLReader {
+public:
+    /** Check whether a file is a binary STL file. The size of a binary file is
+      * fixed by the triangle count in its header, which tells it apart from an
+      * ASCII file even when the header starts with "solid".
+      * @param fileName is the file to check
+      * @return true if the file can be read by this reader
+      */
+    static bool canRead(const QString& fileName);
+
+    /** Read a binary STL file.
+      * Every triangle gets its own three points, points are not merged.
+      * @param fileName is the file to read
+      * @return the geometry, or nullptr if the file is not a valid binary STL file
+      */
+    static vtkSmartPointer<vtkPolyData> read(const QString& fileName);
+
+    /** Read an evenly spaced sample of the triangles in a binary STL file,
+      * to show as a cheap stand-in while the full file is loading.
+      * @param fileName is the file to read
+      * @param maxTriangles is the most triangles to return
+      * @return the sampled geometry, or nullptr if the file is not a valid binary STL file
+      */
+    static vtkSmartPointer<vtkPolyData> readSampled(const QString& fileName, vtkIdType maxTriangles);
+};
+
+#endif
@@ -0,0 +1,269 @@
+/**     @file FilterPipeline.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Persistent chain of filter stages applied to a part's geometry. Each
+  *     stage remembers its last result and only runs again when its input or
+  *     its own parameters change. The work can be planned on the GUI thread,
+  *     run on a worker and the results handed back to the pipeline.
+  */
+
+#include "FilterPipeline.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+FilterStage::~FilterStage() {
+}
+
+int FilterStage::parameterCount() const {
+    return int(parameters.size());
+}
+
+QString FilterStage::parameterName(int index) const {
+    return parameters[index].name;
+}
+
+double FilterStage::parameter(int index) const {
+    return parameters[index].value;
+}
+
+void FilterStage::parameterRange(int index, double& minimum, double& maximum) const {
+    minimum = parameters[index].minimum;
+    maximum = parameters[index].maximum;
+}
+
+void FilterStage::setParameter(int index, double value) {
+    Parameter& p = parameters[index];
+    value = std::clamp(value, p.minimum, p.maximum);
+    if (value == p.value)
+        return;
+    p.value = value;
+    modified();
+}
+
+void FilterStage::copySettings(const FilterStage& other) {
+    setEnabled(other.isEnabled());
+    for (int i = 0; i < parameterCount() && i < other.parameterCount(); i++)
+        setParameter(i, other.parameter(i));
+}
+
+int FilterStage::addParameter(const QString& name, double value, double minimum, double maximum) {
+    parameters.push_back({ name, value, minimum, maximum });
+    return parameterCount() - 1;
+}
+
+bool FilterStage::isEnabled() const {
+    return enabled;
+}
+
+void FilterStage::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+/**
+ * @brief Gets the stage's result, reusing the last one where possible.
+ *
+ * The input is compared by identity and modification time, so a new
+ * upstream result or geometry changed in place both cause a re-run.
+ *
+ * @param input The geometry to filter.
+ * @return The filtered geometry.
+ */
+vtkSmartPointer<vtkPolyData> FilterStage::update(vtkPolyData* input) {
+    if (input == nullptr)
+        return nullptr;
+
+    vtkPolyData* cached = cachedResult(input);
+    if (cached != nullptr)
+        return cached;
+
+    QElapsedTimer timer;
+    timer.start();
+    vtkSmartPointer<vtkPolyData> output = kernel()(input);
+    store(input, version, output, timer.nsecsElapsed() / 1.0e6);
+    return cachedOutput;
+}
+
+vtkPolyData* FilterStage::cachedResult(vtkPolyData* input) const {
+    if (cachedOutput == nullptr || input == nullptr || cachedInput != input || cachedInputTime != input->GetMTime())
+        return nullptr;
+    return cachedOutput;
+}
+
+double FilterStage::getRunTime() const {
+    return runTime;
+}
+
+vtkIdType FilterStage::getOutputCellCount() const {
+    return outputCells;
+}
+
+quint64 FilterStage::getVersion() const {
+    return version;
+}
+
+void FilterStage::store(vtkPolyData* input, quint64 resultVersion, vtkSmartPointer<vtkPolyData> output, double milliseconds) {
+    if (resultVersion != version || input == nullptr || output == nullptr)
+        return;
+
+    cachedOutput = output;
+    cachedInput = input;
+    cachedInputTime = input->GetMTime();
+    runTime = milliseconds;
+    outputCells = output->GetNumberOfCells();
+}
+
+void FilterStage::releaseCache() {
+    cachedInput = nullptr;
+    cachedOutput = nullptr;
+}
+
+void FilterStage::modified() {
+    version++;
+    cachedOutput = nullptr;
+}
+
+void FilterPipeline::setInput(vtkSmartPointer<vtkPolyData> data) {
+    input = data;
+}
+
+vtkPolyData* FilterPipeline::getInput() const {
+    return input;
+}
+
+void FilterPipeline::appendStage(FilterStage* stage) {
+    stages.emplace_back(stage);
+}
+
+void FilterPipeline::insertStage(int index, FilterStage* stage) {
+    stages.emplace(stages.begin() + std::clamp(index, 0, stageCount()), stage);
+}
+
+void FilterPipeline::removeStage(int index) {
+    stages.erase(stages.begin() + index);
+}
+
+void FilterPipeline::clearStages() {
+    stages.clear();
+}
+
+void FilterPipeline::moveStage(int from, int to) {
+    std::shared_ptr<FilterStage> moved = stages[from];
+    stages.erase(stages.begin() + from);
+    stages.insert(stages.begin() + std::clamp(to, 0, stageCount()), moved);
+}
+
+int FilterPipeline::stageCount() const {
+    return int(stages.size());
+}
+
+FilterStage* FilterPipeline::stage(int index) const {
+    return stages[index].get();
+}
+
+bool FilterPipeline::hasEnabledStages() const {
+    for (const std::shared_ptr<FilterStage>& stage : stages) {
+        if (stage->isEnabled())
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Runs the pipeline.
+ *
+ * Disabled stages are skipped without losing their cached results, so a
+ * stage switched off and on again with unchanged upstream geometry costs
+ * nothing, and switching off a downstream stage just hands back the cached
+ * result of the stage before it.
+ *
+ * @return The output of the last enabled stage.
+ */
+vtkSmartPointer<vtkPolyData> FilterPipeline::update() {
+    vtkSmartPointer<vtkPolyData> data = input;
+    for (const std::shared_ptr<FilterStage>& stage : stages) {
+        if (stage->isEnabled())
+            data = stage->update(data);
+    }
+    return data;
+}
+
+/**
+ * @brief Plans the work needed to update the output.
+ *
+ * Cached results are followed as far as they go. From the first enabled
+ * stage without one, every enabled stage has to run because its input
+ * will be new.
+ *
+ * @return The job to run.
+ */
+FilterPipeline::Job FilterPipeline::plan() const {
+    Job job;
+    job.input = input;
+
+    for (const std::shared_ptr<FilterStage>& s : stages) {
+        if (!s->isEnabled())
+            continue;
+
+        if (job.steps.empty()) {
+            vtkPolyData* cached = s->cachedResult(job.input);
+            if (cached != nullptr || job.input == nullptr) {
+                job.input = cached;
+                continue;
+            }
+        }
+        job.steps.push_back({ s, s->getVersion(), s->kernel() });
+    }
+    return job;
+}
+
+/**
+ * @brief Runs a job's kernels, timing each one.
+ *
+ * Each kernel is given a shallow copy of its input. Filters build cell and
+ * bounds lookups on their input as they go, and the copy keeps those
+ * lookups away from geometry the GUI thread may be rendering.
+ */
+bool FilterPipeline::run(const Job& job, const std::atomic<bool>& cancelled, std::vector<Job::Result>& results) {
+    vtkSmartPointer<vtkPolyData> data = job.input;
+    for (const Job::Step& step : job.steps) {
+        if (cancelled || data == nullptr)
+            return false;
+
+        vtkSmartPointer<vtkPolyData> view = vtkSmartPointer<vtkPolyData>::New();
+        view->ShallowCopy(data);
+
+        QElapsedTimer timer;
+        timer.start();
+        data = step.kernel(view);
+        results.push_back({ data, timer.nsecsElapsed() / 1.0e6 });
+    }
+    return true;
+}
+
+/**
+ * @brief Stores a job's results in the stages that made them.
+ *
+ * Each stage checks the parameter version itself, so results from a job
+ * whose settings have since changed are not kept. Stages removed from the
+ * pipeline since the job was planned are skipped.
+ *
+ * The result is that of the stack as it was planned. If stages have been
+ * added, removed or moved since, it is out of date and the caller should
+ * run the pipeline again.
+ */
+vtkSmartPointer<vtkPolyData> FilterPipeline::commit(const Job& job, const std::vector<Job::Result>& results) {
+    vtkSmartPointer<vtkPolyData> data = job.input;
+    for (size_t i = 0; i < job.steps.size(); i++) {
+        if (i >= results.size())
+            return nullptr;
+
+        std::shared_ptr<FilterStage> stage = job.steps[i].stage.lock();
+        if (stage != nullptr)
+            stage->store(data, job.steps[i].version, results[i].output, results[i].milliseconds);
+        data = results[i].output;
+    }
+    return data;
+}
@@ -0,0 +1,271 @@
+/**     @file FilterPipeline.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Persistent chain of filter stages applied to a part's geometry. Each
+  *     stage remembers its last result and only runs again when its input or
+  *     its own parameters change. The work can be planned on the GUI thread,
+  *     run on a worker and the results handed back to the pipeline.
+  */
+
+#ifndef VIEWER_FILTERPIPELINE_H
+#define VIEWER_FILTERPIPELINE_H
+
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/* Stage inputs and outputs are treated as read-only, a stage always
+ * builds a new polydata rather than changing the one it was given.
+ * Stages and pipelines belong to the GUI thread, only kernels and jobs
+ * are used on workers. Parameters are plain numbers, so stages can be
+ * edited and saved without knowing their type. */
+class FilterStage {
+public:
+    /** Function that runs a stage with the parameters it had when the kernel
+      * was made. It holds copies of those parameters, so it can run on a
+      * worker thread while the stage itself is changed.
+      */
+    typedef std::function<vtkSmartPointer<vtkPolyData>(vtkPolyData*)> Kernel;
+
+    virtual ~FilterStage();
+
+    /** Get the name shown for the stage
+      * @return the stage name
+      */
+    virtual QString name() const = 0;
+
+    /** Get the number of parameters the stage has
+      * @return number of parameters
+      */
+    int parameterCount() const;
+
+    /** Get the name shown for a parameter
+      * @param index is the parameter number
+      * @return the parameter name
+      */
+    QString parameterName(int index) const;
+
+    /** Get a parameter's value
+      * @param index is the parameter number
+      * @return the value
+      */
+    double parameter(int index) const;
+
+    /** Get the range a parameter can take
+      * @param index is the parameter number
+      * @param minimum receives the lowest value allowed
+      * @param maximum receives the highest value allowed
+      */
+    void parameterRange(int index, double& minimum, double& maximum) const;
+
+    /** Change a parameter, the last result is dropped if the value changes
+      * @param index is the parameter number
+      * @param value is the new value, clamped to the parameter's range
+      */
+    void setParameter(int index, double value);
+
+    /** Copy the enabled flag and parameters of another stage of the same type
+      * @param other is the stage to copy
+      */
+    void copySettings(const FilterStage& other);
+
+    /** Check whether the stage is applied
+      * @return true if enabled
+      */
+    bool isEnabled() const;
+
+    /** Switch the stage on or off. A disabled stage passes its input straight
+      * through but keeps its last result, so switching it back on is free if
+      * the input has not changed.
+      * @param enabled is true to apply the stage
+      */
+    void setEnabled(bool enabled);
+
+    /** Get the stage's output for an input, running the stage only if the
+      * input or parameters have changed since the last run
+      * @param input is the geometry to filter
+      * @return the filtered geometry
+      */
+    vtkSmartPointer<vtkPolyData> update(vtkPolyData* input);
+
+    /** Get the last result if it was made from an input
+      * @param input is the geometry the result should come from
+      * @return the cached result, or nullptr if the stage needs to run
+      */
+    vtkPolyData* cachedResult(vtkPolyData* input) const;
+
+    /** Get a kernel that runs the stage with its current parameters
+      * @return the kernel
+      */
+    virtual Kernel kernel() const = 0;
+
+    /** Get how long the stage took the last time it ran
+      * @return time in milliseconds, negative if the stage has not run
+      */
+    double getRunTime() const;
+
+    /** Get the size of the stage's last result
+      * @return number of cells, negative if the stage has not run
+      */
+    vtkIdType getOutputCellCount() const;
+
+    /** Get a number that changes each time a parameter changes
+      * @return the parameter version
+      */
+    quint64 getVersion() const;
+
+    /** Remember a result made elsewhere, e.g. by a kernel on a worker thread.
+      * Results made with out of date parameters are ignored.
+      * @param input is the geometry the kernel was run on
+      * @param version is getVersion() when the kernel was made
+      * @param output is the kernel's result
+      * @param milliseconds is how long the kernel took
+      */
+    void store(vtkPolyData* input, quint64 version, vtkSmartPointer<vtkPolyData> output, double milliseconds);
+
+    /** Forget the last result, e.g. to free its memory */
+    void releaseCache();
+
+protected:
+    /** Declare a parameter, called by the constructors of derived stages
+      * @param name is the name shown for it
+      * @param value is its initial value
+      * @param minimum is the lowest value allowed
+      * @param maximum is the highest value allowed
+      * @return the parameter number
+      */
+    int addParameter(const QString& name, double value, double minimum, double maximum);
+
+    /** Mark the last result as out of date, called when a parameter changes */
+    void modified();
+
+private:
+    struct Parameter {
+        QString     name;
+        double      value;
+        double      minimum;
+        double      maximum;
+    };
+
+    bool                            enabled = false;
+    std::vector<Parameter>          parameters;
+    quint64                         version = 0;            /**< Bumped by modified() */
+    vtkSmartPointer<vtkPolyData>    cachedInput;            /**< Input the cached output was made from */
+    vtkMTimeType                    cachedInputTime = 0;    /**< Modification time of that input when it was used */
+    vtkSmartPointer<vtkPolyData>    cachedOutput;           /**< Last result, nullptr if out of date */
+    double                          runTime = -1.0;         /**< Milliseconds taken by the last run */
+    vtkIdType                       outputCells = -1;       /**< Cells in the last result */
+};
+
+class FilterPipeline {
+public:
+    /** Work needed to bring a pipeline's output up to date: the stages from
+      * the first one without a usable cached result to the end */
+    struct Job {
+        struct Step {
+            std::weak_ptr<FilterStage>  stage;      /**< Stage to store the result in, if it is still in the pipeline */
+            quint64                     version;    /**< Stage parameter version the kernel was made with */
+            FilterStage::Kernel         kernel;
+        };
+
+        /** Output of one step and how long it took */
+        struct Result {
+            vtkSmartPointer<vtkPolyData> output;
+            double                      milliseconds;
+        };
+
+        vtkSmartPointer<vtkPolyData>    input;      /**< Input of the first step, or the result if there are no steps */
+        std::vector<Step>               steps;
+    };
+
+    /** Set the geometry at the start of the pipeline
+      * @param data is the unfiltered geometry
+      */
+    void setInput(vtkSmartPointer<vtkPolyData> data);
+
+    /** Get the geometry at the start of the pipeline
+      * @return the unfiltered geometry
+      */
+    vtkPolyData* getInput() const;
+
+    /** Add a stage to the end of the pipeline
+      * @param stage is the stage, the pipeline takes ownership
+      */
+    void appendStage(FilterStage* stage);
+
+    /** Add a stage part way along the pipeline
+      * @param index is the position the stage will have
+      * @param stage is the stage, the pipeline takes ownership
+      */
+    void insertStage(int index, FilterStage* stage);
+
+    /** Remove and delete a stage. Jobs already planned still run it but
+      * their result for it is not kept.
+      * @param index is the position of the stage
+      */
+    void removeStage(int index);
+
+    /** Remove and delete every stage */
+    void clearStages();
+
+    /** Move a stage to another position. The stages keep their cached
+      * results, which are only used if their input is unchanged.
+      * @param from is the current position of the stage
+      * @param to is the position it will have
+      */
+    void moveStage(int from, int to);
+
+    /** Get the number of stages
+      * @return number of stages, enabled or not
+      */
+    int stageCount() const;
+
+    /** Get a stage
+      * @param index is the position of the stage in the pipeline
+      * @return the stage
+      */
+    FilterStage* stage(int index) const;
+
+    /** Check whether any stage is switched on
+      * @return true if the output differs from the input
+      */
+    bool hasEnabledStages() const;
+
+    /** Get the output of the last enabled stage. Only stages whose input or
+      * parameters have changed are run.
+      * @return the filtered geometry, the input itself if no stage is enabled
+      */
+    vtkSmartPointer<vtkPolyData> update();
+
+    /** Work out which stages need to run to update the output
+      * @return the job, with no steps if the output is already cached
+      */
+    Job plan() const;
+
+    /** Run a job's kernels one after another. Safe to call on a worker thread.
+      * @param job is from plan()
+      * @param cancelled is checked between steps
+      * @param results receives the output and run time of each step
+      * @return false if cancelled before all steps were run
+      */
+    static bool run(const Job& job, const std::atomic<bool>& cancelled, std::vector<Job::Result>& results);
+
+    /** Store the results of a job in the stages' caches
+      * @param job is from plan()
+      * @param results is from run(), may be incomplete if the job was cancelled
+      * @return the pipeline output the job made, nullptr if incomplete
+      */
+    vtkSmartPointer<vtkPolyData> commit(const Job& job, const std::vector<Job::Result>& results);
+
+private:
+    vtkSmartPointer<vtkPolyData>                input;
+    std::vector<std::shared_ptr<FilterStage>>   stages;     /**< Shared with planned jobs so edits cannot leave them dangling */
+};
+
+#endif
@@ -0,0 +1,114 @@
+/**     @file FilterRunner.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Runs part filter pipelines on a pool of worker threads, one task per
+  *     part, so applying filters to a large assembly does not block the GUI.
+  */
+
+#include "FilterRunner.h"
+
+#include <QThread>
+
+#include <vector>
+
+
+FilterRunner::FilterRunner(QObject* parent)
+    : QObject(parent) {
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+FilterRunner::~FilterRunner() {
+    cancel();
+    pool.waitForDone();
+}
+
+void FilterRunner::run(FilterPipeline* pipeline, Callback onDone, bool interactive) {
+    /* A newer request replaces any stale one for the same pipeline, unless
+     * it is interactive and the stale one is already being worked on */
+    auto stale = requests.find(pipeline);
+    if (stale != requests.end()) {
+        if (interactive && *stale->started) {
+            stale->rerun = true;
+            stale->rerunDone = onDone;
+            return;
+        }
+        *stale->cancelled = true;
+        requests.erase(stale);
+        requestDone();
+    }
+
+    /* Work out what needs doing here, the pipeline itself is never touched
+     * by the workers. Nothing to do means the result is already cached. */
+    FilterPipeline::Job job = pipeline->plan();
+    if (job.steps.empty()) {
+        onDone(job.input);
+        return;
+    }
+
+    Request request = { nextTicket++, std::make_shared<std::atomic<bool>>(false),
+                        std::make_shared<std::atomic<bool>>(false), onDone, false, Callback() };
+    requests.insert(pipeline, request);
+    total++;
+    emit progress(done, total);
+
+    quint64 ticket = request.ticket;
+    std::shared_ptr<std::atomic<bool>> flag = request.cancelled;
+    std::shared_ptr<std::atomic<bool>> started = request.started;
+
+    pool.start([this, pipeline, job, ticket, flag, started]() {
+        *started = true;
+        std::vector<FilterPipeline::Job::Result> results;
+        FilterPipeline::run(job, *flag, results);
+        if (*flag)
+            return;
+
+        QMetaObject::invokeMethod(this, [this, pipeline, job, ticket, results]() {
+            auto it = requests.find(pipeline);
+            if (it == requests.end() || it->ticket != ticket)
+                return;
+
+            Callback onDone = it->onDone;
+            bool rerun = it->rerun;
+            Callback rerunDone = it->rerunDone;
+            requests.erase(it);
+
+            /* The pipeline keeps the results for next time, unless its
+             * settings changed while the task was running */
+            onDone(pipeline->commit(job, results));
+            requestDone();
+
+            if (rerun)
+                run(pipeline, rerunDone, true);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FilterRunner::requestDone() {
+    done++;
+    emit progress(done, total);
+
+    if (done == total) {
+        done = 0;
+        total = 0;
+        emit finished();
+    }
+}
+
+void FilterRunner::cancel() {
+    if (requests.isEmpty())
+        return;
+
+    for (const Request& request : requests)
+        *request.cancelled = true;
+    pool.clear();
+    requests.clear();
+
+    done = 0;
+    total = 0;
+    emit finished();
+}
+
+bool FilterRunner::isBusy() const {
+    return total > 0;
+}
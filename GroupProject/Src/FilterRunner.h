@@ -0,0 +1,98 @@
+/**     @file FilterRunner.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Runs part filter pipelines on a pool of worker threads, one task per
+  *     part, so applying filters to a large assembly does not block the GUI.
+  */
+
+#ifndef VIEWER_FILTERRUNNER_H
+#define VIEWER_FILTERRUNNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QThreadPool>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "FilterPipeline.h"
+
+class FilterRunner : public QObject {
+    Q_OBJECT
+public:
+    /** Function called on the GUI thread with a pipeline's new output */
+    typedef std::function<void(vtkSmartPointer<vtkPolyData>)> Callback;
+
+    /** Constructor
+      * @param parent is the owning QObject
+      */
+    FilterRunner(QObject* parent = nullptr);
+
+    /** Destructor
+      * Cancels any outstanding work and waits for running tasks to finish
+      */
+    ~FilterRunner();
+
+    /** Bring a pipeline's output up to date in the background. Any earlier
+      * request for the same pipeline that has not finished is cancelled. If
+      * the output is already cached the callback is called straight away.
+      *
+      * Interactive requests come in quick series, e.g. while a slider is
+      * dragged. For those a task that is already running is left to finish
+      * and its result shown, and only the latest of the requests made in the
+      * meantime runs after it, so the view keeps up as well as it can
+      * instead of cancelling every task before it finishes.
+      * @param pipeline is the pipeline to update, it must stay alive until the
+      *        callback has been called or cancel() is called
+      * @param onDone is called on the GUI thread with the pipeline's output,
+      *        nullptr if a stage failed
+      * @param interactive is true for one of a quick series of requests
+      */
+    void run(FilterPipeline* pipeline, Callback onDone, bool interactive = false);
+
+    /** Cancel all outstanding requests, e.g. before the pipelines are deleted.
+      * Tasks already running finish the stage they are on and are discarded.
+      */
+    void cancel();
+
+    /** Check whether there are any requests outstanding
+      * @return true if busy
+      */
+    bool isBusy() const;
+
+signals:
+    /** Emitted each time a pipeline has been updated
+      * @param done is the number of pipelines updated in the current batch
+      * @param total is the number of pipelines requested in the current batch
+      */
+    void progress(int done, int total);
+
+    /** Emitted when the last request in a batch has finished or been cancelled */
+    void finished();
+
+private:
+    /* An outstanding request, only touched on the GUI thread */
+    struct Request {
+        quint64                             ticket;
+        std::shared_ptr<std::atomic<bool>>  cancelled;
+        std::shared_ptr<std::atomic<bool>>  started;        /**< Set by the task when it starts running */
+        Callback                            onDone;
+        bool                                rerun;          /**< An interactive request is waiting for this one */
+        Callback                            rerunDone;      /**< Callback of the waiting request */
+    };
+
+    /** Count a request as finished, ending the batch if it was the last one */
+    void requestDone();
+
+    QThreadPool                             pool;               /**< Worker threads, one per core */
+    QHash<FilterPipeline*, Request>         requests;           /**< Latest request for each pipeline */
+    quint64                                 nextTicket = 0;     /**< Identifies each request */
+    int                                     done = 0;           /**< Requests finished in the current batch */
+    int                                     total = 0;          /**< Requests made in the current batch */
+};
+
+#endif
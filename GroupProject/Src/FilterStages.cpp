@@ -0,0 +1,197 @@
+/**     @file FilterStages.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     The filters that can be applied to a part, as FilterPipeline stages.
+  */
+
+#include "FilterStages.h"
+#include "SurfaceClipper.h"
+#include "SurfaceShrinker.h"
+
+#include <vtkPolyDataNormals.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkTriangleFilter.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+#include <array>
+
+/* Run a polydata filter on its own and keep only its output */
+static vtkSmartPointer<vtkPolyData> runFilter(vtkPolyDataAlgorithm* filter) {
+    filter->Update();
+    vtkSmartPointer<vtkPolyData> output = filter->GetOutput();
+    return output;
+}
+
+/* Parameter numbers */
+enum { ShrinkFactor };
+enum { ClipOriginX, ClipOriginY, ClipOriginZ, ClipNormalX, ClipNormalY, ClipNormalZ, ClipCap };
+enum { DecimateReduction, DecimateBoundary };
+enum { SmoothIterations, SmoothPassBand };
+enum { NormalsFeatureAngle };
+
+ShrinkStage::ShrinkStage() {
+    addParameter("Factor", 0.5, 0.01, 1.0);
+}
+
+QString ShrinkStage::name() const {
+    return "Shrink";
+}
+
+void ShrinkStage::setShrinkFactor(double factor) {
+    setParameter(ShrinkFactor, factor);
+}
+
+double ShrinkStage::getShrinkFactor() const {
+    return parameter(ShrinkFactor);
+}
+
+FilterStage::Kernel ShrinkStage::kernel() const {
+    double factor = getShrinkFactor();
+    return [factor](vtkPolyData* input) {
+        return SurfaceShrinker::shrink(input, factor);
+    };
+}
+
+ClipStage::ClipStage() {
+    addParameter("Origin X", 0.0, -1.0e9, 1.0e9);
+    addParameter("Origin Y", 0.0, -1.0e9, 1.0e9);
+    addParameter("Origin Z", 0.0, -1.0e9, 1.0e9);
+    addParameter("Normal X", 0.0, -1.0, 1.0);
+    addParameter("Normal Y", 1.0, -1.0, 1.0);
+    addParameter("Normal Z", 0.0, -1.0, 1.0);
+    addParameter("Cap (0/1)", 0.0, 0.0, 1.0);
+}
+
+QString ClipStage::name() const {
+    return "Clip";
+}
+
+void ClipStage::setPlane(const double origin[3], const double normal[3]) {
+    for (int i = 0; i < 3; i++) {
+        setParameter(ClipOriginX + i, origin[i]);
+        setParameter(ClipNormalX + i, normal[i]);
+    }
+}
+
+void ClipStage::getPlane(double origin[3], double normal[3]) const {
+    for (int i = 0; i < 3; i++) {
+        origin[i] = parameter(ClipOriginX + i);
+        normal[i] = parameter(ClipNormalX + i);
+    }
+}
+
+void ClipStage::setCapping(bool cap) {
+    setParameter(ClipCap, cap ? 1.0 : 0.0);
+}
+
+bool ClipStage::getCapping() const {
+    return parameter(ClipCap) >= 0.5;
+}
+
+FilterStage::Kernel ClipStage::kernel() const {
+    std::array<double, 3> o, n;
+    getPlane(o.data(), n.data());
+    bool cap = getCapping();
+    return [o, n, cap](vtkPolyData* input) {
+        return SurfaceClipper::clip(input, o.data(), n.data(), cap);
+    };
+}
+
+DecimateStage::DecimateStage() {
+    addParameter("Reduction", 0.5, 0.0, 0.99);
+    addParameter("Keep Boundary (0/1)", 1.0, 0.0, 1.0);
+}
+
+QString DecimateStage::name() const {
+    return "Decimate";
+}
+
+FilterStage::Kernel DecimateStage::kernel() const {
+    double reduction = parameter(DecimateReduction);
+    bool keepBoundary = parameter(DecimateBoundary) >= 0.5;
+    return [reduction, keepBoundary](vtkPolyData* input) {
+        /* Quadric decimation only handles triangles, earlier stages may
+         * have left polygons or strips */
+        vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+        triangleFilter->SetInputData(input);
+        triangleFilter->PassVertsOff();
+        triangleFilter->PassLinesOff();
+
+        vtkSmartPointer<vtkQuadricDecimation> decimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+        decimation->SetInputConnection(triangleFilter->GetOutputPort());
+        decimation->SetTargetReduction(reduction);
+        decimation->SetVolumePreservation(true);
+        decimation->SetBoundaryWeightFactor(keepBoundary ? 100.0 : 1.0);
+        return runFilter(decimation);
+    };
+}
+
+SmoothStage::SmoothStage() {
+    addParameter("Iterations", 20.0, 1.0, 200.0);
+    addParameter("Pass Band", 0.1, 0.001, 2.0);
+}
+
+QString SmoothStage::name() const {
+    return "Smooth";
+}
+
+FilterStage::Kernel SmoothStage::kernel() const {
+    int iterations = int(parameter(SmoothIterations) + 0.5);
+    double passBand = parameter(SmoothPassBand);
+    return [iterations, passBand](vtkPolyData* input) {
+        vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+        smoother->SetInputData(input);
+        smoother->SetNumberOfIterations(iterations);
+        smoother->SetPassBand(passBand);
+        smoother->NormalizeCoordinatesOn();
+        smoother->BoundarySmoothingOff();
+        smoother->FeatureEdgeSmoothingOff();
+        return runFilter(smoother);
+    };
+}
+
+NormalsStage::NormalsStage() {
+    addParameter("Feature Angle", 30.0, 0.0, 180.0);
+}
+
+QString NormalsStage::name() const {
+    return "Normals";
+}
+
+FilterStage::Kernel NormalsStage::kernel() const {
+    double featureAngle = parameter(NormalsFeatureAngle);
+    return [featureAngle](vtkPolyData* input) {
+        vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+        normals->SetInputData(input);
+        normals->SetFeatureAngle(featureAngle);
+        normals->SplittingOn();
+        normals->ConsistencyOn();
+        return runFilter(normals);
+    };
+}
+
+QStringList FilterStages::names() {
+    return { "Shrink", "Clip", "Decimate", "Smooth", "Normals" };
+}
+
+FilterStage* FilterStages::create(const QString& name) {
+    if (name == "Shrink")
+        return new ShrinkStage;
+    if (name == "Clip")
+        return new ClipStage;
+    if (name == "Decimate")
+        return new DecimateStage;
+    if (name == "Smooth")
+        return new SmoothStage;
+    if (name == "Normals")
+        return new NormalsStage;
+    return nullptr;
+}
+
+FilterStage* FilterStages::clone(const FilterStage* stage) {
+    FilterStage* copy = create(stage->name());
+    if (copy != nullptr)
+        copy->copySettings(*stage);
+    return copy;
+}
@@ -0,0 +1,119 @@
+/**     @file FilterStages.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     The filters that can be applied to a part, as FilterPipeline stages.
+  */
+
+#ifndef VIEWER_FILTERSTAGES_H
+#define VIEWER_FILTERSTAGES_H
+
+#include "FilterPipeline.h"
+
+#include <QStringList>
+
+/* Shrinks each cell towards its own centre */
+class ShrinkStage : public FilterStage {
+public:
+    ShrinkStage();
+
+    QString name() const override;
+
+    /** Set how far cells are shrunk
+      * @param factor is 1 for the original size down to 0.01, smaller values are clamped to 0.01
+      */
+    void setShrinkFactor(double factor);
+
+    /** Get how far cells are shrunk
+      * @return the shrink factor
+      */
+    double getShrinkFactor() const;
+
+    Kernel kernel() const override;
+};
+
+/* Cuts away the geometry on the negative side of a plane, working on the
+ * surface directly, and optionally closes the cut with a cap */
+class ClipStage : public FilterStage {
+public:
+    ClipStage();
+
+    QString name() const override;
+
+    /** Set the clip plane
+      * @param origin is a point on the plane
+      * @param normal points towards the side that is kept
+      */
+    void setPlane(const double origin[3], const double normal[3]);
+
+    /** Get the clip plane
+      * @param origin receives a point on the plane
+      * @param normal receives the normal of the plane
+      */
+    void getPlane(double origin[3], double normal[3]) const;
+
+    /** Set whether the cut is closed
+      * @param cap is true to fill the cut with triangles in the plane
+      */
+    void setCapping(bool cap);
+
+    /** Get whether the cut is closed
+      * @return true if capped
+      */
+    bool getCapping() const;
+
+    Kernel kernel() const override;
+};
+
+/* Reduces the number of triangles while keeping the shape, using quadric
+ * error decimation */
+class DecimateStage : public FilterStage {
+public:
+    DecimateStage();
+
+    QString name() const override;
+    Kernel kernel() const override;
+};
+
+/* Smooths the surface with a windowed sinc filter, which shrinks the
+ * model far less than plain Laplacian smoothing */
+class SmoothStage : public FilterStage {
+public:
+    SmoothStage();
+
+    QString name() const override;
+    Kernel kernel() const override;
+};
+
+/* Computes point normals for smooth shading, splitting sharp edges so they
+ * stay crisp */
+class NormalsStage : public FilterStage {
+public:
+    NormalsStage();
+
+    QString name() const override;
+    Kernel kernel() const override;
+};
+
+/* Makes stages by name, for the filter stack editor and project files */
+class FilterStages {
+public:
+    /** Get the names of the stages that can be made
+      * @return stage names, in the order they are offered to the user
+      */
+    static QStringList names();
+
+    /** Make a stage with its default settings
+      * @param name is one of names()
+      * @return the new stage, or nullptr if the name is not known
+      */
+    static FilterStage* create(const QString& name);
+
+    /** Make a copy of a stage's type and settings, without its cached result
+      * @param stage is the stage to copy
+      * @return the new stage
+      */
+    static FilterStage* clone(const FilterStage* stage);
+};
+
+#endif
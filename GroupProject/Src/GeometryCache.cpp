@@ -0,0 +1,402 @@
+/**     @file GeometryCache.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     On-disk cache of processed part geometry, keyed by the content of the
+  *     STL file, so unchanged parts are not parsed again on the next load.
+  */
+
+#include "GeometryCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkTypeInt32Array.h>
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+struct CacheHeader {
+    char        magic[4];
+    quint32     reserved;
+    quint64     points;
+    quint64     triangles;
+};
+
+static const char cacheMagic[4] = { 'V', 'G', 'C', '1' };
+
+/* Size, modification time and content hash of a file that has been hashed before */
+struct IndexEntry {
+    qint64      size;
+    qint64      modified;
+    QByteArray  hash;
+};
+
+static std::atomic<bool>            enabled(true);
+static std::atomic<qint64>          maxSize(qint64(4) * 1024 * 1024 * 1024);
+
+/* The index and cache folder are shared by all loader threads */
+static QMutex                       mutex;
+static QHash<QString, IndexEntry>   fileIndex;
+static bool                         indexLoaded = false;
+static bool                         indexDirty = false;
+static qint64                       cacheSize = -1;     /**< Total size of the cache files, -1 until first counted */
+
+/* Eviction goes down to this fraction of the size limit, so the folder is
+ * only scanned again once a tenth of the limit has been stored */
+static const double                 evictTarget = 0.9;
+
+static QString indexFile() {
+    return GeometryCache::directory() + "/index.json";
+}
+
+static QString cacheFile(const QByteArray& key) {
+    return GeometryCache::directory() + "/" + QString::fromLatin1(key) + ".vgc";
+}
+
+/* Read the remembered file hashes, the mutex must be held. Files that have
+ * been deleted or changed since are left out, their hashes are no use. */
+static void loadIndex() {
+    if (indexLoaded)
+        return;
+    indexLoaded = true;
+
+    QFile file(indexFile());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QJsonObject entries = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        QJsonObject entry = it.value().toObject();
+        IndexEntry indexEntry = { qint64(entry["size"].toDouble()),
+                                  qint64(entry["modified"].toDouble()),
+                                  QByteArray::fromHex(entry["hash"].toString().toLatin1()) };
+
+        QFileInfo info(it.key());
+        if (!info.isFile() || info.size() != indexEntry.size
+            || info.lastModified().toMSecsSinceEpoch() != indexEntry.modified) {
+            indexDirty = true;
+            continue;
+        }
+        fileIndex.insert(it.key(), indexEntry);
+    }
+}
+
+/* The content hash a cache file was stored under, its name is the hash then the weld tolerance */
+static QByteArray hashOfCacheFile(const QFileInfo& info) {
+    return QByteArray::fromHex(info.completeBaseName().section('_', 0, 0).toLatin1());
+}
+
+/* Count the size of the cache files once, the mutex must be held. After
+ * that the total is kept up to date as files are stored and evicted. */
+static void countCacheSize() {
+    if (cacheSize >= 0)
+        return;
+
+    cacheSize = 0;
+    QDir dir(GeometryCache::directory());
+    for (const QFileInfo& info : dir.entryInfoList({ "*.vgc" }, QDir::Files))
+        cacheSize += info.size();
+}
+
+/* Account for a file written to the cache and evict if it is now too big,
+ * the mutex must be held. Only a cache over its limit is scanned, and it is
+ * then brought down below the limit so the next few stores do not scan again.
+ * Cache hits update a file's modification time, so oldest first is least recently used. */
+static void added(qint64 bytes) {
+    countCacheSize();
+    cacheSize += bytes;
+    if (cacheSize <= maxSize)
+        return;
+
+    QDir dir(GeometryCache::directory());
+    QFileInfoList files = dir.entryInfoList({ "*.vgc" }, QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo& info : files)
+        total += info.size();
+
+    qint64 target = qint64(double(maxSize) * evictTarget);
+    QSet<QByteArray> evicted;
+    std::vector<bool> removed(files.size(), false);
+    for (int i = 0; i < files.size() && total > target; i++) {
+        if (QFile::remove(files[i].absoluteFilePath())) {
+            total -= files[i].size();
+            evicted.insert(hashOfCacheFile(files[i]));
+            removed[i] = true;
+        }
+    }
+    cacheSize = total;
+
+    /* Forget the hashes of files with nothing left in the cache, unless the
+     * same content is still cached at another weld tolerance */
+    for (int i = 0; i < files.size(); i++) {
+        if (!removed[i])
+            evicted.remove(hashOfCacheFile(files[i]));
+    }
+    if (evicted.isEmpty())
+        return;
+
+    loadIndex();
+    for (auto it = fileIndex.begin(); it != fileIndex.end(); ) {
+        if (evicted.contains(it->hash)) {
+            it = fileIndex.erase(it);
+            indexDirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+QByteArray GeometryCache::contentHash(const QString& fileName) {
+    QFileInfo info(fileName);
+    if (!info.isFile())
+        return QByteArray();
+
+    QString path = info.canonicalFilePath();
+    qint64 size = info.size();
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker lock(&mutex);
+        loadIndex();
+        auto it = fileIndex.constFind(path);
+        if (it != fileIndex.constEnd() && it->size == size && it->modified == modified)
+            return it->hash;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return QByteArray();
+    QByteArray result = hash.result();
+
+    QMutexLocker lock(&mutex);
+    fileIndex.insert(path, { size, modified, result });
+    indexDirty = true;
+    return result;
+}
+
+/* Hashes the file's path, size and modification time rather than its
+ * content, so nothing is read. The content hash is used if already known. */
+QByteArray GeometryCache::fileIdentity(const QString& fileName) {
+    QFileInfo info(fileName);
+    if (!info.isFile())
+        return QByteArray();
+
+    QString path = info.canonicalFilePath();
+    qint64 size = info.size();
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker lock(&mutex);
+        loadIndex();
+        auto it = fileIndex.constFind(path);
+        if (it != fileIndex.constEnd() && it->size == size && it->modified == modified)
+            return it->hash;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(path.toUtf8());
+    hash.addData(QByteArray::number(size) + "_" + QByteArray::number(modified));
+    return "file" + hash.result();
+}
+
+QByteArray GeometryCache::key(const QString& fileName, double weldTolerance) {
+    QByteArray hash = enabled ? contentHash(fileName) : fileIdentity(fileName);
+    if (hash.isEmpty())
+        return QByteArray();
+
+    /* Processed geometry depends on the weld tolerance as well as the file */
+    return hash.toHex() + "_" + QByteArray::number(weldTolerance, 'g', 17);
+}
+
+vtkSmartPointer<vtkPolyData> GeometryCache::load(const QByteArray& key) {
+    if (!enabled || key.isEmpty())
+        return nullptr;
+
+    /* Read only, so a cache folder that cannot be written still serves hits */
+    QFile file(cacheFile(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    qint64 size = file.size();
+    if (size < qint64(sizeof(CacheHeader)))
+        return nullptr;
+
+    const uchar* data = file.map(0, size);
+    if (data == nullptr)
+        return nullptr;
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.points > quint64(VTK_TYPE_INT32_MAX) || 3 * header.triangles > quint64(VTK_TYPE_INT32_MAX)
+        || quint64(size) != sizeof(CacheHeader) + 3 * sizeof(float) * header.points + 3 * sizeof(vtkTypeInt32) * header.triangles)
+        return nullptr;
+
+    vtkIdType points = vtkIdType(header.points);
+    vtkIdType triangles = vtkIdType(header.triangles);
+    const uchar* pointData = data + sizeof(CacheHeader);
+    const uchar* connData = pointData + 3 * sizeof(float) * points;
+
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(points);
+    std::memcpy(coords->GetPointer(0), pointData, 3 * sizeof(float) * points);
+
+    vtkSmartPointer<vtkTypeInt32Array> connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(3 * triangles);
+    std::memcpy(connectivity->GetPointer(0), connData, 3 * sizeof(vtkTypeInt32) * triangles);
+
+    vtkSmartPointer<vtkTypeInt32Array> offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(triangles + 1);
+    vtkTypeInt32* offset = offsets->GetPointer(0);
+    vtkSMPTools::For(0, triangles + 1, 65536, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++)
+            offset[t] = vtkTypeInt32(3 * t);
+    });
+
+    file.unmap(const_cast<uchar*>(data));
+
+    /* Mark the entry as recently used, where the folder allows it */
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    vtkSmartPointer<vtkPoints> pts = vtkSmartPointer<vtkPoints>::New();
+    pts->SetData(coords);
+
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(pts);
+    output->SetPolys(polys);
+    return output;
+}
+
+void GeometryCache::store(const QByteArray& key, vtkPolyData* data) {
+    if (!enabled || key.isEmpty() || data == nullptr)
+        return;
+
+    vtkPoints* points = data->GetPoints();
+    vtkCellArray* polys = data->GetPolys();
+    if (points == nullptr || polys == nullptr || polys->IsHomogeneous() != 3
+        || data->GetNumberOfVerts() || data->GetNumberOfLines() || data->GetNumberOfStrips())
+        return;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.reserved = 0;
+    header.points = quint64(points->GetNumberOfPoints());
+    header.triangles = quint64(polys->GetNumberOfCells());
+    if (header.points > quint64(VTK_TYPE_INT32_MAX) || 3 * header.triangles > quint64(VTK_TYPE_INT32_MAX))
+        return;
+
+    /* Points and connectivity are written as they are when already in the
+     * cache's types, otherwise they are converted first */
+    std::vector<float> pointCopy;
+    const char* pointBytes;
+    vtkFloatArray* floatPoints = vtkFloatArray::SafeDownCast(points->GetData());
+    if (floatPoints)
+        pointBytes = reinterpret_cast<const char*>(floatPoints->GetPointer(0));
+    else {
+        pointCopy.resize(3 * header.points);
+        for (vtkIdType i = 0; i < vtkIdType(header.points); i++) {
+            double p[3];
+            points->GetPoint(i, p);
+            pointCopy[3 * i] = float(p[0]);
+            pointCopy[3 * i + 1] = float(p[1]);
+            pointCopy[3 * i + 2] = float(p[2]);
+        }
+        pointBytes = reinterpret_cast<const char*>(pointCopy.data());
+    }
+
+    std::vector<vtkTypeInt32> connCopy;
+    const char* connBytes;
+    vtkTypeInt32Array* conn32 = vtkTypeInt32Array::SafeDownCast(polys->GetConnectivityArray());
+    if (conn32)
+        connBytes = reinterpret_cast<const char*>(conn32->GetPointer(0));
+    else {
+        vtkDataArray* conn = polys->GetConnectivityArray();
+        connCopy.resize(3 * header.triangles);
+        for (vtkIdType i = 0; i < vtkIdType(connCopy.size()); i++)
+            connCopy[i] = vtkTypeInt32(conn->GetComponent(i, 0));
+        connBytes = reinterpret_cast<const char*>(connCopy.data());
+    }
+
+    QDir().mkpath(directory());
+    QString fileName = cacheFile(key);
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    qint64 bytes = qint64(sizeof(header) + 3 * sizeof(float) * header.points + 3 * sizeof(vtkTypeInt32) * header.triangles);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(pointBytes, qint64(3 * sizeof(float) * header.points));
+    file.write(connBytes, qint64(3 * sizeof(vtkTypeInt32) * header.triangles));
+
+    /* Two threads can store the same key, the file they replace no longer counts */
+    QMutexLocker lock(&mutex);
+    QFileInfo previous(fileName);
+    qint64 replaced = previous.exists() ? previous.size() : 0;
+    if (!file.commit())
+        return;
+    added(bytes - replaced);
+}
+
+void GeometryCache::flush() {
+    QMutexLocker lock(&mutex);
+    if (!indexDirty)
+        return;
+
+    QJsonObject entries;
+    for (auto it = fileIndex.constBegin(); it != fileIndex.constEnd(); ++it) {
+        QJsonObject entry;
+        entry["size"] = double(it->size);
+        entry["modified"] = double(it->modified);
+        entry["hash"] = QString::fromLatin1(it->hash.toHex());
+        entries[it.key()] = entry;
+    }
+
+    QDir().mkpath(directory());
+    QSaveFile file(indexFile());
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+    if (file.commit())
+        indexDirty = false;
+}
+
+void GeometryCache::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+bool GeometryCache::isEnabled() {
+    return enabled;
+}
+
+void GeometryCache::setMaxSize(qint64 bytes) {
+    maxSize = bytes;
+}
+
+QString GeometryCache::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/geometry";
+}
@@ -0,0 +1,95 @@
+/**     @file GeometryCache.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     On-disk cache of processed part geometry, keyed by the content of the
+  *     STL file, so unchanged parts are not parsed again on the next load.
+  */
+
+#ifndef VIEWER_GEOMETRYCACHE_H
+#define VIEWER_GEOMETRYCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/* All functions are static and safe to call from several loader threads at once.
+ *
+ * Cache file layout (native byte order):
+ *   char    magic[4]        "VGC1"
+ *   uint32  reserved
+ *   uint64  number of points
+ *   uint64  number of triangles
+ *   float   points[3 * number of points]
+ *   int32   connectivity[3 * number of triangles]
+ */
+class GeometryCache {
+public:
+    /** Get a hash of a file's content. The hash is remembered along with the
+      * file's size and modification time, so an unchanged file is only hashed once.
+      * @param fileName is the file to hash
+      * @return the hash, empty if the file cannot be read
+      */
+    static QByteArray contentHash(const QString& fileName);
+
+    /** Get the cache key for a file processed with a given weld tolerance.
+      * While the cache is disabled the file is not read: the key names the
+      * file by its path, size and modification time instead of its content,
+      * so only parts loaded from the same file share geometry.
+      * @param fileName is the STL file
+      * @param weldTolerance is the tolerance its vertices are welded with
+      * @return the key, empty if the file cannot be read
+      */
+    static QByteArray key(const QString& fileName, double weldTolerance);
+
+    /** Load geometry from the cache
+      * @param key is from key()
+      * @return the geometry, or nullptr if not cached or the cache is disabled
+      */
+    static vtkSmartPointer<vtkPolyData> load(const QByteArray& key);
+
+    /** Store geometry in the cache, evicting the least recently used entries
+      * if the cache grows beyond its size limit. The cache's total size is
+      * kept as files are stored, so the folder is only scanned when
+      * something has to be evicted. Only triangle polydata is stored.
+      * @param key is from key()
+      * @param data is the geometry to store
+      */
+    static void store(const QByteArray& key, vtkPolyData* data);
+
+    /** Write the remembered file hashes to disk. Hashes of files whose
+      * geometry has been evicted, or that were deleted or changed since
+      * they were hashed, are dropped rather than kept for ever. */
+    static void flush();
+
+    /** Enable or bypass the cache
+      * @param enabled is false to always parse files
+      */
+    static void setEnabled(bool enabled);
+
+    /** Check whether the cache is in use
+      * @return true if enabled
+      */
+    static bool isEnabled();
+
+    /** Set the size limit of the cache
+      * @param bytes is the maximum total size of the cache files
+      */
+    static void setMaxSize(qint64 bytes);
+
+    /** Get the folder the cache files are kept in
+      * @return the folder path
+      */
+    static QString directory();
+
+private:
+    /** Get a key for a file without reading it
+      * @param fileName is the file
+      * @return the content hash if already known, otherwise a hash of the
+      *         file's path, size and modification time
+      */
+    static QByteArray fileIdentity(const QString& fileName);
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**     @file GeometryRegistry.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps one copy in memory of each distinct piece of part geometry, so
+  *     parts loaded from the same file (or from files with identical content)
+  *     share a single polydata object.
+  */
+
+#include "GeometryRegistry.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <atomic>
+
+static QMutex                                               mutex;
+static QHash<QByteArray, vtkSmartPointer<vtkPolyData>>      entries;
+static std::atomic<bool>                                    prunePending(false);
+
+/* Drop entries that nothing but the registry refers to, the mutex must be held.
+ * The reference count is atomic, and other threads can only lower it while
+ * this runs: once only the registry holds a reference, the count can only
+ * go up again through find()/add(), which also take the mutex. So a count
+ * of 1 is safe to act on, and a reference dropped on another thread while
+ * this runs only leaves the entry until the next prune. */
+static void prune() {
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (it.value()->GetReferenceCount() == 1)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+vtkSmartPointer<vtkPolyData> GeometryRegistry::find(const QByteArray& key) {
+    if (key.isEmpty())
+        return nullptr;
+
+    QMutexLocker lock(&mutex);
+    auto it = entries.constFind(key);
+    if (it == entries.constEnd())
+        return nullptr;
+    return it.value();
+}
+
+vtkSmartPointer<vtkPolyData> GeometryRegistry::add(const QByteArray& key, vtkSmartPointer<vtkPolyData> data) {
+    if (key.isEmpty() || data == nullptr)
+        return data;
+
+    QMutexLocker lock(&mutex);
+    prune();
+
+    auto it = entries.constFind(key);
+    if (it != entries.constEnd())
+        return it.value();
+
+    entries.insert(key, data);
+    return data;
+}
+
+void GeometryRegistry::released() {
+    if (prunePending.exchange(true))
+        return;
+
+    auto run = []() {
+        prunePending = false;
+        QMutexLocker lock(&mutex);
+        prune();
+    };
+
+    /* Without an event loop there is nothing to wait for */
+    if (QCoreApplication::instance() == nullptr)
+        run();
+    else
+        QMetaObject::invokeMethod(QCoreApplication::instance(), run, Qt::QueuedConnection);
+}
+
+int GeometryRegistry::count() {
+    QMutexLocker lock(&mutex);
+    prune();
+    return entries.size();
+}
@@ -0,0 +1,52 @@
+/**     @file GeometryRegistry.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps one copy in memory of each distinct piece of part geometry, so
+  *     parts loaded from the same file (or from files with identical content)
+  *     share a single polydata object.
+  */
+
+#ifndef VIEWER_GEOMETRYREGISTRY_H
+#define VIEWER_GEOMETRYREGISTRY_H
+
+#include <QByteArray>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/* Entries are reference counted through the polydata itself: an entry is
+ * released once the registry holds the only reference to its geometry.
+ * Parts say when they let go of geometry, and entries are checked then, so
+ * memory is given back as soon as the last part using it goes. All
+ * functions are safe to call from several loader threads at once. */
+class GeometryRegistry {
+public:
+    /** Find geometry that is already in use
+      * @param key identifies the content, e.g. from GeometryCache::key()
+      * @return the shared geometry, or nullptr if nothing with this key is loaded
+      */
+    static vtkSmartPointer<vtkPolyData> find(const QByteArray& key);
+
+    /** Register newly loaded geometry. If another thread registered the same
+      * key first, its geometry is returned instead so that both share it.
+      * @param key identifies the content
+      * @param data is the geometry
+      * @return the geometry that should be used for this key
+      */
+    static vtkSmartPointer<vtkPolyData> add(const QByteArray& key, vtkSmartPointer<vtkPolyData> data);
+
+    /** Note that a part has let go of its geometry, called on the GUI thread.
+      * Entries nothing else uses are dropped once control returns to the
+      * event loop, by which time the part has released every reference it
+      * held, including those of its mapper and filters. Several calls in
+      * one pass of the event loop are checked together.
+      */
+    static void released();
+
+    /** Get the number of distinct pieces of geometry currently shared
+      * @return number of entries still in use
+      */
+    static int count();
+};
+
+#endif
@@ -0,0 +1,54 @@
+/**     @file LODBuilder.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Builds a chain of successively coarser copies of a surface, used to
+  *     draw parts that cover little of the screen with fewer triangles.
+  */
+
+#include "LODBuilder.h"
+
+#include <vtkQuadricDecimation.h>
+#include <vtkTriangleFilter.h>
+
+QList<vtkSmartPointer<vtkPolyData>> LODBuilder::build(vtkPolyData* input, vtkIdType minCells,
+                                                      const std::atomic<bool>& cancelled) {
+    /* vtkQuadricDecimation's target reduction, the fraction of the triangles
+     * removed from each level, so each keeps about a quarter of the one before */
+    const double targetReduction = 0.75;
+    const int maxLevels = 5;
+
+    QList<vtkSmartPointer<vtkPolyData>> levels;
+    if (input == nullptr || input->GetNumberOfPolys() + input->GetNumberOfStrips() < 2 * minCells)
+        return levels;
+
+    /* Quadric decimation only handles triangles */
+    vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+    triangleFilter->SetInputData(input);
+    triangleFilter->PassVertsOff();
+    triangleFilter->PassLinesOff();
+    triangleFilter->Update();
+    vtkSmartPointer<vtkPolyData> previous = triangleFilter->GetOutput();
+
+    while (levels.size() < maxLevels && !cancelled) {
+        vtkIdType previousCells = previous->GetNumberOfPolys();
+        if (previousCells * (1.0 - targetReduction) < minCells)
+            break;
+
+        vtkSmartPointer<vtkQuadricDecimation> decimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+        decimation->SetInputData(previous);
+        decimation->SetTargetReduction(targetReduction);
+        decimation->SetVolumePreservation(true);
+        decimation->Update();
+
+        /* Surfaces with many boundary edges or sharp features stop shrinking early */
+        vtkSmartPointer<vtkPolyData> level = decimation->GetOutput();
+        if (level->GetNumberOfPolys() == 0 || level->GetNumberOfPolys() > previousCells * 0.9)
+            break;
+
+        levels.append(level);
+        previous = level;
+    }
+
+    return levels;
+}
@@ -0,0 +1,34 @@
+/**     @file LODBuilder.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Builds a chain of successively coarser copies of a surface, used to
+  *     draw parts that cover little of the screen with fewer triangles.
+  */
+
+#ifndef VIEWER_LODBUILDER_H
+#define VIEWER_LODBUILDER_H
+
+#include <QList>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <atomic>
+
+class LODBuilder {
+public:
+    /** Decimate a surface again and again, each level having about a quarter
+      * of the triangles of the one before, until a level would have fewer
+      * than minCells triangles or stops getting smaller. Each level is made
+      * from the one before, so the whole chain costs little more than the
+      * first level. Safe to call from a worker thread.
+      * @param input is the full resolution surface, it is not changed
+      * @param minCells is the size below which no more levels are made
+      * @param cancelled is checked between levels, the chain so far is returned once it is set
+      * @return the levels from finest to coarsest, empty if the surface is already small
+      */
+    static QList<vtkSmartPointer<vtkPolyData>> build(vtkPolyData* input, vtkIdType minCells,
+                                                     const std::atomic<bool>& cancelled);
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**     @file LODManager.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Makes levels of detail for parts in the background and picks the
+  *     level each part is drawn at every frame, from its size on screen
+  *     and how long recent frames have taken.
+  */
+
+#include "LODManager.h"
+#include "LODBuilder.h"
+#include "ModelPart.h"
+
+#include <QThread>
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkMath.h>
+#include <vtkRenderWindow.h>
+
+#include <algorithm>
+#include <cmath>
+
+/* Parts smaller than this are always drawn at full resolution */
+static const vtkIdType minCells = 2000;
+
+/* Triangles a part may use for each pixel of its size on screen, squared */
+static const double trianglesPerPixel = 0.5;
+
+LODManager::LODManager(vtkRenderer* renderer, QObject* parent)
+    : QObject(parent), renderer(renderer) {
+    /* Leave most of the cores to loading and filtering, levels are only a speed-up */
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+
+    startTag = renderer->AddObserver(vtkCommand::StartEvent, this, &LODManager::select);
+    endTag = renderer->AddObserver(vtkCommand::EndEvent, this, &LODManager::frameDrawn);
+
+    refineTimer.setSingleShot(true);
+    refineTimer.setInterval(300);
+    connect(&refineTimer, &QTimer::timeout, this, &LODManager::refine);
+}
+
+LODManager::~LODManager() {
+    renderer->RemoveObserver(startTag);
+    renderer->RemoveObserver(endTag);
+    clear();
+    pool.waitForDone();
+}
+
+void LODManager::partChanged(ModelPart* part) {
+    stopWaiting(part);
+
+    vtkPolyData* source = part->getShownGeometry();
+    if (source == nullptr || part->getLevelOfDetailCount() == 1)
+        parts.remove(part);
+    if (source == nullptr || part->getLevelOfDetailCount() > 1 || source->GetNumberOfCells() < 2 * minCells)
+        return;
+
+    /* Parts showing the same geometry share one build */
+    auto existing = builds.find(source);
+    if (existing != builds.end()) {
+        existing->parts.insert(part);
+        waiting.insert(part, source);
+        return;
+    }
+
+    Build build = { source, std::make_shared<std::atomic<bool>>(false), { part } };
+    builds.insert(source, build);
+    waiting.insert(part, source);
+
+    vtkSmartPointer<vtkPolyData> input = build.source;
+    std::shared_ptr<std::atomic<bool>> flag = build.cancelled;
+    pool.start([this, input, flag]() {
+        QList<vtkSmartPointer<vtkPolyData>> levels = LODBuilder::build(input, minCells, *flag);
+        if (*flag)
+            return;
+
+        QMetaObject::invokeMethod(this, [this, input, flag, levels]() {
+            auto it = builds.find(input.Get());
+            if (it == builds.end() || it->cancelled != flag)
+                return;
+
+            QSet<ModelPart*> waitingParts = it->parts;
+            builds.erase(it);
+            for (ModelPart* part : waitingParts) {
+                waiting.remove(part);
+                if (!levels.isEmpty() && part->setLevelsOfDetail(input, levels))
+                    parts.insert(part);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void LODManager::stopWaiting(ModelPart* part) {
+    auto it = waiting.find(part);
+    if (it == waiting.end())
+        return;
+
+    auto build = builds.find(it.value());
+    waiting.erase(it);
+    if (build == builds.end())
+        return;
+
+    build->parts.remove(part);
+    if (build->parts.isEmpty()) {
+        *build->cancelled = true;
+        builds.erase(build);
+    }
+}
+
+void LODManager::clear() {
+    for (const Build& build : builds)
+        *build.cancelled = true;
+    pool.clear();
+    builds.clear();
+    waiting.clear();
+    parts.clear();
+    refineTimer.stop();
+}
+
+void LODManager::setEnabled(bool enable) {
+    enabled = enable;
+    detail = 1.0;
+    if (!enabled) {
+        for (ModelPart* part : parts)
+            part->showLevelOfDetail(0);
+    }
+}
+
+void LODManager::setTargetFrameRate(double framesPerSecond) {
+    targetFrameTime = 1.0 / std::max(1.0, framesPerSecond);
+}
+
+/**
+ * @brief Gives each part with levels the finest one that fits its budget.
+ *
+ * A part's budget is its size on screen in pixels, squared, times the
+ * detail scale. Parts that are hidden, e.g. drawn by a glyph actor, are
+ * left alone.
+ */
+void LODManager::select() {
+    frameTimer.start();
+    if (!enabled || parts.isEmpty())
+        return;
+
+    vtkCamera* camera = renderer->GetActiveCamera();
+    double height = std::max(1, renderer->GetSize()[1]);
+    double eye[3];
+    camera->GetPosition(eye);
+
+    /* Pixels per unit of length at unit distance, or at any distance for a parallel view */
+    bool parallel = camera->GetParallelProjection();
+    double pixelsPerUnit = parallel
+        ? height / (2.0 * camera->GetParallelScale())
+        : height / (2.0 * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0));
+    double scale = refining ? 1.0 : detail;
+
+    for (ModelPart* part : parts) {
+        vtkActor* actor = part->getActor();
+        if (!actor->GetVisibility())
+            continue;
+
+        double bounds[6], centre[3];
+        actor->GetBounds(bounds);
+        for (int i = 0; i < 3; i++)
+            centre[i] = (bounds[2 * i] + bounds[2 * i + 1]) / 2.0;
+        double corner[3] = { bounds[1], bounds[3], bounds[5] };
+        double radius = std::sqrt(vtkMath::Distance2BetweenPoints(centre, corner));
+
+        /* The camera inside the bounds means the part fills the view */
+        double distance = std::sqrt(vtkMath::Distance2BetweenPoints(eye, centre));
+        if (!parallel && distance <= radius) {
+            part->showLevelOfDetail(0);
+            continue;
+        }
+
+        double pixels = 2.0 * radius * pixelsPerUnit / (parallel ? 1.0 : distance);
+        double budget = pixels * pixels * trianglesPerPixel * scale;
+
+        int level = 0;
+        int count = part->getLevelOfDetailCount();
+        while (level + 1 < count && part->getLevelOfDetailCells(level) > budget)
+            level++;
+        part->showLevelOfDetail(level);
+    }
+}
+
+/**
+ * @brief Adjusts the detail scale from the time the frame took.
+ *
+ * The scale drops quickly while frames are slow and recovers slowly while
+ * they are well inside the target, so it settles instead of flickering
+ * between levels.
+ */
+void LODManager::frameDrawn() {
+    if (refining) {
+        refining = false;
+        return;
+    }
+    if (!enabled || parts.isEmpty())
+        return;
+
+    double frameTime = frameTimer.nsecsElapsed() / 1.0e9;
+    if (frameTime > targetFrameTime)
+        detail = std::max(0.01, detail * 0.7);
+    else if (frameTime < targetFrameTime / 2.0)
+        detail = std::min(1.0, detail * 1.1);
+
+    if (detail < 1.0)
+        refineTimer.start();
+}
+
+void LODManager::refine() {
+    refining = true;
+    renderer->GetRenderWindow()->Render();
+}
@@ -0,0 +1,107 @@
+/**     @file LODManager.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Makes levels of detail for parts in the background and picks the
+  *     level each part is drawn at every frame, from its size on screen
+  *     and how long recent frames have taken.
+  */
+
+#ifndef VIEWER_LODMANAGER_H
+#define VIEWER_LODMANAGER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+
+#include <atomic>
+#include <memory>
+
+class ModelPart;
+
+/* Each part with enough triangles gets a chain of decimated copies once its
+ * geometry arrives or its filters produce new output. Just before each
+ * render every part with levels is given the finest level whose triangle
+ * count fits its share of the screen. That budget is scaled down while
+ * frames take longer than the target frame time and back up while they are
+ * quick, and once the view has been still for a moment one frame is drawn
+ * with the full budget. Only used on the GUI thread. */
+class LODManager : public QObject {
+    Q_OBJECT
+public:
+    /** Constructor
+      * @param renderer is the renderer the parts are drawn in
+      * @param parent is the owning QObject
+      */
+    LODManager(vtkRenderer* renderer, QObject* parent = nullptr);
+
+    /** Destructor
+      * Cancels outstanding work and waits for running tasks to finish
+      */
+    ~LODManager();
+
+    /** Make levels for a part's shown geometry if it does not have them,
+      * called when the geometry it shows has changed
+      * @param part is the part
+      */
+    void partChanged(ModelPart* part);
+
+    /** Forget every part and cancel outstanding work, called before the
+      * parts are deleted */
+    void clear();
+
+    /** Switch level selection on or off, parts are drawn at full
+      * resolution while it is off
+      * @param enabled is true to pick levels
+      */
+    void setEnabled(bool enabled);
+
+    /** Set the frame time the detail budget is adjusted towards
+      * @param framesPerSecond is the target frame rate
+      */
+    void setTargetFrameRate(double framesPerSecond);
+
+private:
+    /** Pick a level for each part, called as each render starts */
+    void select();
+
+    /** Adjust the detail budget from the frame just drawn */
+    void frameDrawn();
+
+    /** Draw one frame with the full budget once the view is still */
+    void refine();
+
+    vtkSmartPointer<vtkRenderer>            renderer;           /**< Kept alive until the observers are removed */
+    unsigned long                           startTag;
+    unsigned long                           endTag;
+
+    /* An outstanding build, shared by every part showing the same geometry */
+    struct Build {
+        vtkSmartPointer<vtkPolyData>        source;
+        std::shared_ptr<std::atomic<bool>>  cancelled;
+        QSet<ModelPart*>                    parts;          /**< Parts waiting for the levels */
+    };
+
+    /** Stop a part waiting for levels, cancelling the build if nothing else waits */
+    void stopWaiting(ModelPart* part);
+
+    QThreadPool                             pool;               /**< Builds levels without holding up loads and filters */
+    QHash<vtkPolyData*, Build>              builds;             /**< Outstanding builds by source geometry */
+    QHash<ModelPart*, vtkPolyData*>         waiting;            /**< Source each waiting part's build is for */
+    QSet<ModelPart*>                        parts;              /**< Parts that have levels */
+
+    bool                                    enabled = true;
+    double                                  targetFrameTime = 1.0 / 60.0;   /**< Seconds */
+    double                                  detail = 1.0;       /**< Scale on each part's triangle budget */
+    bool                                    refining = false;   /**< The frame being drawn is the still frame */
+    QElapsedTimer                           frameTimer;
+    QTimer                                  refineTimer;
+};
+
+#endif
@@ -8,27 +8,82 @@
   */
 
 #include "ModelPart.h"
+#include "BinarySTLReader.h"
+#include "AsciiSTLReader.h"
+#include "VertexWelder.h"
+#include "GeometryCache.h"
+#include "GeometryRegistry.h"
+#include "PartChangeNotifier.h"
+#include "SharedGeometry.h"
 
 
 /* Commented out for now, will be uncommented later when you have
  * installed the VTK library
  */
-#include <vtkDataSetMapper.h>
 #include <vtkSmartPointer.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <QVector3D>
-#include <vtkShrinkFilter.h>
-#include <vtkGeometryFilter.h>
-#include <vtkPlane.h>
-#include <vtkClipDataSet.h>
+#include <QSet>
+#include <vtkSTLReader.h>
+#include <vtkOutlineSource.h>
+
+#include <atomic>
+
+
+/* Filter settings given to new parts, only used on the GUI thread */
+static double defaultShrinkFactor = 0.5;
+static double defaultClipOrigin[3] = { 0.0, 0.0, 0.0 };
+static double defaultClipNormal[3] = { 0.0, 1.0, 0.0 };
+static bool defaultClipCapping = false;
+static vtkPlane* defaultSectionPlane = nullptr;
+
+/* Parts with a section plane, so moving a plane only visits the parts it cuts */
+static QSet<ModelPart*> sectionedParts;
+
+/* Call f for each stage of type Stage in a part's filter stack */
+template <class Stage, class Function>
+static void forEachStage(const FilterPipeline& filters, Function f) {
+    for (int i = 0; i < filters.stageCount(); i++) {
+        Stage* stage = dynamic_cast<Stage*>(filters.stage(i));
+        if (stage != nullptr)
+            f(stage);
+    }
+}
+
+/* Check whether a stage of type Stage is switched on in a filter stack */
+template <class Stage>
+static bool hasEnabledStage(const FilterPipeline& filters) {
+    bool found = false;
+    forEachStage<Stage>(filters, [&found](Stage* stage) { found = found || stage->isEnabled(); });
+    return found;
+}
 
+/* Switch every stage of type Stage on or off, adding one if there is none
+ * to switch on */
+template <class Stage>
+static void enableStages(FilterPipeline& filters, const QString& name, bool enable) {
+    bool found = false;
+    forEachStage<Stage>(filters, [&found, enable](Stage* stage) {
+        stage->setEnabled(enable);
+        found = true;
+    });
+
+    if (!found && enable) {
+        FilterStage* stage = ModelPart::createFilterStage(name);
+        stage->setEnabled(true);
+        filters.appendStage(stage);
+    }
+}
 
 ModelPart::ModelPart(const QList<QVariant>& data, ModelPart* parent)
     : m_itemData(data), m_parentItem(parent), originalPosition(QVector3D(0, 0, 0)) {
     file = nullptr;
     mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
     actor = vtkSmartPointer<vtkActor>::New();
+    setSectionPlane(defaultSectionPlane);
+    filters.appendStage(createFilterStage("Shrink"));
+    filters.appendStage(createFilterStage("Clip"));
     /* You probably want to give the item a default colour - Initalized default with colour */
     actor->VisibilityOn();      // Do the same with this, ModelPart should be default visible.
 }
@@ -40,7 +95,12 @@ ModelPart::ModelPart(const QList<QVariant>& data, ModelPart* parent)
  */
 ModelPart::~ModelPart() {
     qDeleteAll(m_childItems);
-    
+    PartChangeNotifier::instance()->forget(this);
+    sectionedParts.remove(this);
+
+    /* Shared geometry only this part used can now be freed */
+    if (file != nullptr)
+        GeometryRegistry::released();
 }
 
 void ModelPart::appendChild( ModelPart* item ) {
@@ -51,6 +111,11 @@ void ModelPart::appendChild( ModelPart* item ) {
     m_childItems.append(item);
 }
 
+void ModelPart::deleteChildren() {
+    qDeleteAll(m_childItems);
+    m_childItems.clear();
+}
+
 ModelPart* ModelPart::child( int row ) {
     /* Return pointer to child item in row below this item.
      */
@@ -102,34 +167,232 @@ int ModelPart::row() const {
         return m_parentItem->m_childItems.indexOf(const_cast<ModelPart*>(this));
     return 0;
 }
+/* Distance within which STL vertices are welded, shared by all loader threads */
+static std::atomic<double> weldTolerance(0.0);
+
 /**
- * @brief Loads an STL file for the model part.
+ * @brief Reads an STL file without modifying any part.
+ *
+ * Each call uses its own reader so several files can be read at once
+ * from different threads. Binary and ASCII files go through the
+ * memory-mapped BinarySTLReader/AsciiSTLReader and their triangle corners
+ * are welded into shared vertices, anything they cannot handle falls
+ * back to vtkSTLReader (which merges points itself). The processed
+ * geometry is kept in the GeometryCache, so an unchanged file is only
+ * parsed once, and in the GeometryRegistry, so parts with the same
+ * content share one copy in memory. With the cache disabled the file is
+ * not hashed and only parts from the same file share.
  *
- * @param fileName The name of the STL file to load.
+ * @param fileName The name of the STL file to read.
+ * @return The polydata read from the file, or nullptr on failure.
  */
-void ModelPart::loadSTL(QString fileName) {
-    // Load the STL file
-    file = vtkSmartPointer<vtkSTLReader>::New();
-    file->SetFileName(fileName.toStdString().c_str());
-    file->Update();
-
-    // Check if the file is loaded correctly
-    if (file->GetOutput() == nullptr) {
-        qDebug() << "Failed to load STL file: " << fileName;
-        return;
+vtkSmartPointer<vtkPolyData> ModelPart::readSTL(const QString& fileName) {
+    QByteArray key = GeometryCache::key(fileName, weldTolerance);
+
+    vtkSmartPointer<vtkPolyData> shared = GeometryRegistry::find(key);
+    if (shared != nullptr)
+        return shared;
+
+    vtkSmartPointer<vtkPolyData> cached = GeometryCache::load(key);
+    if (cached != nullptr)
+        return GeometryRegistry::add(key, cached);
+
+    vtkSmartPointer<vtkPolyData> data;
+    if (BinarySTLReader::canRead(fileName))
+        data = BinarySTLReader::read(fileName);
+    else if (AsciiSTLReader::canRead(fileName))
+        data = AsciiSTLReader::read(fileName);
+
+    if (data != nullptr) {
+        data = VertexWelder::weld(data, weldTolerance);
+    }
+    else {
+        vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
+        reader->SetFileName(fileName.toStdString().c_str());
+        reader->Update();
+
+        data = reader->GetOutput();
+        if (data == nullptr || data->GetNumberOfPoints() == 0)
+            return nullptr;
     }
 
+    GeometryCache::store(key, data);
+    return GeometryRegistry::add(key, data);
+}
+
+/**
+ * @brief Sets the tolerance used to weld vertices of newly read STL files.
+ *
+ * @param tolerance Largest distance between merged points, 0 only merges identical coordinates.
+ */
+void ModelPart::setWeldTolerance(double tolerance) {
+    weldTolerance = tolerance;
+}
+
+/**
+ * @brief Gets the tolerance used to weld vertices of newly read STL files.
+ *
+ * @return The weld tolerance.
+ */
+double ModelPart::getWeldTolerance() {
+    return weldTolerance;
+}
+
+/**
+ * @brief Installs geometry for the part and connects it to the renderer.
+ *
+ * The new geometry becomes the input of the part's filters and is shown
+ * unfiltered, run getFilters() on a FilterRunner and pass the result to
+ * showFiltered() to show it filtered.
+ *
+ * @param data The geometry to display.
+ */
+void ModelPart::setGeometry(vtkSmartPointer<vtkPolyData> data) {
+    if (file != nullptr)
+        GeometryRegistry::released();
+
+    file = vtkSmartPointer<vtkTrivialProducer>::New();
+    file->SetOutput(data);
+    proxy = nullptr;
+
     // Initialize the part's mapper and actor
-    mapper->SetInputConnection(file->GetOutputPort());
-    actor->SetMapper(mapper);
+    showGeometry(data);
 
-    // Set the original position now that the STL is loaded
+    filters.setInput(data);
+    notifyChange(PartChangeNotifier::Geometry);
+    setLoadState(Loaded);
+
+    // Set the original position now that the STL is loaded, the actor keeps
+    // any position it was given before the geometry arrived
     if (originalPosition == QVector3D(0, 0, 0)) {
         originalPosition = QVector3D(actor->GetPosition()[0], actor->GetPosition()[1], actor->GetPosition()[2]);
     }
+}
 
-    // Update the VTK actor's position
-    actor->SetPosition(originalPosition.x(), originalPosition.y(), originalPosition.z());
+/**
+ * @brief Gets the part's unfiltered geometry if it can be drawn as an instance.
+ *
+ * Parts with filters switched on draw their own filtered copy, so they
+ * cannot share a draw call with other parts.
+ *
+ * @return The loaded geometry, or nullptr if not loaded or filtered.
+ */
+vtkPolyData* ModelPart::getInstanceGeometry() const {
+    if (filters.hasEnabledStages())
+        return nullptr;
+    return getGeometry();
+}
+
+/**
+ * @brief Gets the part's geometry as loaded, before any filters.
+ * @return The geometry, or nullptr if it has not been loaded.
+ */
+vtkPolyData* ModelPart::getGeometry() const {
+    if (file == nullptr)
+        return nullptr;
+    return vtkPolyData::SafeDownCast(file->GetOutputDataObject(0));
+}
+
+/**
+ * @brief Shows stand-in geometry until the real geometry has been loaded.
+ *
+ * The proxy is replaced as soon as setGeometry() is called, and is ignored
+ * if the geometry is already there.
+ *
+ * @param data A cheap approximation of the part, e.g. from readProxy().
+ */
+void ModelPart::setProxy(vtkSmartPointer<vtkPolyData> data) {
+    if (file != nullptr || data == nullptr)
+        return;
+
+    proxy = data;
+    shown = nullptr;
+    lods.clear();
+    lodLevel = 0;
+    mapper->SetInputDataObject(proxy);
+    actor->SetMapper(mapper);
+    notifyChange(PartChangeNotifier::Geometry);
+}
+
+/**
+ * @brief Shows the outline of a box in place of geometry that has not been loaded yet.
+ *
+ * @param bounds The box as xmin, xmax, ymin, ymax, zmin, zmax.
+ */
+void ModelPart::setProxyBounds(const double bounds[6]) {
+    vtkSmartPointer<vtkOutlineSource> outline = vtkSmartPointer<vtkOutlineSource>::New();
+    outline->SetBounds(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+    outline->Update();
+
+    setProxy(outline->GetOutput());
+}
+
+/**
+ * @brief Reads a coarse sample of an STL file's triangles.
+ *
+ * This only touches a small part of the file so it is much quicker than
+ * readSTL(). Like readSTL() it is safe to call from a worker thread.
+ *
+ * @param fileName The name of the STL file to sample.
+ * @return The sampled triangles, or nullptr if the file cannot be sampled.
+ */
+vtkSmartPointer<vtkPolyData> ModelPart::readProxy(const QString& fileName) {
+    const vtkIdType proxyTriangles = 20000;
+
+    if (BinarySTLReader::canRead(fileName))
+        return BinarySTLReader::readSampled(fileName, proxyTriangles);
+    if (AsciiSTLReader::canRead(fileName))
+        return AsciiSTLReader::readSampled(fileName, proxyTriangles);
+    return nullptr;
+}
+
+/**
+ * @brief Gets the bounding box of the part's geometry.
+ *
+ * Before the geometry is loaded this is the box of the proxy, if one was set.
+ *
+ * @param bounds Receives xmin, xmax, ymin, ymax, zmin, zmax.
+ * @return False if the part has neither geometry nor a proxy.
+ */
+bool ModelPart::getBounds(double bounds[6]) const {
+    if (file != nullptr) {
+        vtkDataSet::SafeDownCast(file->GetOutputDataObject(0))->GetBounds(bounds);
+        return true;
+    }
+    if (proxy != nullptr) {
+        proxy->GetBounds(bounds);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Gets the file the part was loaded from.
+ *
+ * @return The STL file name.
+ */
+QString ModelPart::getFileName() const {
+    return sourceFile;
+}
+
+ModelPart::LoadState ModelPart::getLoadState() const {
+    return loadState;
+}
+
+void ModelPart::setLoadState(LoadState state) {
+    if (state == loadState)
+        return;
+    loadState = state;
+    notifyChange(PartChangeNotifier::LoadState);
+}
+
+/**
+ * @brief Sets the file the part was loaded from.
+ *
+ * @param fileName The STL file name.
+ */
+void ModelPart::setFileName(const QString& fileName) {
+    sourceFile = fileName;
 }
 
 
@@ -139,6 +402,8 @@ void ModelPart::loadSTL(QString fileName) {
  * @param Clr The color to set for the model part.
  */
 void ModelPart::setColour(QColor Clr) {
+    if (Clr != Colour)
+        notifyChange(PartChangeNotifier::Colour);
     if ((Clr != Colour) && (this->getTopLevelBool())){
         Colour = Clr;
         // Set the colour of all children to the same colour
@@ -157,7 +422,11 @@ void ModelPart::setColour(QColor Clr) {
  */
 
 void ModelPart::setVisible(const bool isvisible) {
+    set(1, isvisible ? "true" : "false");
+    if (isvisible == isVisible)
+        return;
     isVisible = isvisible;
+    notifyChange(PartChangeNotifier::Visibility);
 }
 
 /**
@@ -166,7 +435,11 @@ void ModelPart::setVisible(const bool isvisible) {
  * @param name The name to set for the model part.
  */
 void ModelPart::setName(const QString name) {
+    set(0, name);
+    if (name == Name)
+        return;
     Name = name;
+    notifyChange(PartChangeNotifier::Name);
 }
 
 /**
@@ -178,6 +451,14 @@ const QColor ModelPart::getColor(void) {
     return Colour;
 }
 
+bool ModelPart::getShrinkStatus() const {
+    return hasEnabledStage<ShrinkStage>(filters);
+}
+
+bool ModelPart::getClipStatus() const {
+    return hasEnabledStage<ClipStage>(filters);
+}
+
 void ModelPart::shrink(const bool filterFlag) {
     if (this->getTopLevelBool()) {
         for (int i = 0; i < m_childItems.size(); i++) {
@@ -185,8 +466,8 @@ void ModelPart::shrink(const bool filterFlag) {
         }
         return;
     }
-    shrinkStatus = filterFlag;
-    applyFilters();
+    enableStages<ShrinkStage>(filters, "Shrink", filterFlag);
+    notifyChange(PartChangeNotifier::Filters);
 }
 
 void ModelPart::clip(const bool filterFlag) {
@@ -196,40 +477,197 @@ void ModelPart::clip(const bool filterFlag) {
         }
         return;
     }
-    clipStatus = filterFlag;
-    applyFilters();
+    enableStages<ClipStage>(filters, "Clip", filterFlag);
+    notifyChange(PartChangeNotifier::Filters);
 }
 
-void ModelPart::applyFilters() {
-    vtkSmartPointer<vtkAlgorithm> lastFilter = file;
+void ModelPart::setClipCapping(bool cap) {
+    forEachStage<ClipStage>(filters, [cap](ClipStage* stage) { stage->setCapping(cap); });
+    notifyChange(PartChangeNotifier::Filters);
+    for (int i = 0; i < m_childItems.size(); i++)
+        m_childItems[i]->setClipCapping(cap);
+}
 
-    if (shrinkStatus) {
-        vtkSmartPointer<vtkShrinkFilter> shrinkFilter = vtkSmartPointer<vtkShrinkFilter>::New();
-        shrinkFilter->SetInputConnection(lastFilter->GetOutputPort());
-        shrinkFilter->SetShrinkFactor(0.5);
-        shrinkFilter->Update();
-        lastFilter = shrinkFilter;
+void ModelPart::setDefaultClipCapping(bool cap) {
+    defaultClipCapping = cap;
+}
+
+void ModelPart::setShrinkFactor(double factor) {
+    forEachStage<ShrinkStage>(filters, [factor](ShrinkStage* stage) { stage->setShrinkFactor(factor); });
+    notifyChange(PartChangeNotifier::Filters);
+    for (int i = 0; i < m_childItems.size(); i++)
+        m_childItems[i]->setShrinkFactor(factor);
+}
+
+void ModelPart::setDefaultShrinkFactor(double factor) {
+    defaultShrinkFactor = factor;
+}
+
+void ModelPart::setClipPlane(const double origin[3], const double normal[3]) {
+    forEachStage<ClipStage>(filters, [origin, normal](ClipStage* stage) { stage->setPlane(origin, normal); });
+    notifyChange(PartChangeNotifier::Filters);
+    for (int i = 0; i < m_childItems.size(); i++)
+        m_childItems[i]->setClipPlane(origin, normal);
+}
+
+void ModelPart::setDefaultClipPlane(const double origin[3], const double normal[3]) {
+    for (int i = 0; i < 3; i++) {
+        defaultClipOrigin[i] = origin[i];
+        defaultClipNormal[i] = normal[i];
     }
+}
 
-    if (clipStatus) {
-        vtkSmartPointer<vtkPlane> planeLeft = vtkSmartPointer<vtkPlane>::New();
-        planeLeft->SetOrigin(0.0, 0.0, 0.0);
-        planeLeft->SetNormal(0.0, 1.0, 0.0);
+void ModelPart::setSectionPlane(vtkPlane* plane) {
+    if (plane != sectionPlane) {
+        sectionPlane = plane;
+        mapper->RemoveAllClippingPlanes();
+        if (plane != nullptr) {
+            mapper->AddClippingPlane(plane);
+            sectionedParts.insert(this);
+        } else {
+            sectionedParts.remove(this);
+        }
+        notifyChange(PartChangeNotifier::Section);
+    }
 
-        vtkSmartPointer<vtkClipDataSet> clipFilter = vtkSmartPointer<vtkClipDataSet>::New();
-        clipFilter->SetInputConnection(lastFilter->GetOutputPort());
-        clipFilter->SetClipFunction(planeLeft.Get());
-        clipFilter->Update();
-        lastFilter = clipFilter;
+    for (int i = 0; i < m_childItems.size(); i++)
+        m_childItems[i]->setSectionPlane(plane);
+}
+
+void ModelPart::sectionPlaneMoved(vtkPlane* plane) {
+    for (ModelPart* part : sectionedParts) {
+        if (part->sectionPlane == plane)
+            part->notifyChange(PartChangeNotifier::Section);
+    }
+}
+
+vtkPlane* ModelPart::getSectionPlane() const {
+    return sectionPlane;
+}
+
+void ModelPart::setDefaultSectionPlane(vtkPlane* plane) {
+    defaultSectionPlane = plane;
+}
+
+/**
+ * @brief Gets the part's filter pipeline, e.g. to run it on a FilterRunner.
+ * @return The pipeline, its input is the part's geometry.
+ */
+FilterPipeline* ModelPart::getFilters() {
+    return &filters;
+}
+
+/**
+ * @brief Gives this part and every part below it a copy of a filter stack.
+ *
+ * Each part gets its own stages, so parameters can still be changed per
+ * part afterwards. The source may be this part's own pipeline.
+ *
+ * @param source The stack to copy.
+ */
+void ModelPart::setFilterStack(const FilterPipeline* source) {
+    if (source != &filters) {
+        filters.clearStages();
+        for (int i = 0; i < source->stageCount(); i++)
+            filters.appendStage(FilterStages::clone(source->stage(i)));
+        notifyChange(PartChangeNotifier::Filters);
     }
 
-    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
-    geometryFilter->SetInputConnection(lastFilter->GetOutputPort());
-    geometryFilter->Update();
+    for (int i = 0; i < m_childItems.size(); i++)
+        m_childItems[i]->setFilterStack(source);
+}
+
+FilterStage* ModelPart::createFilterStage(const QString& name) {
+    FilterStage* stage = FilterStages::create(name);
+
+    if (ShrinkStage* shrinkStage = dynamic_cast<ShrinkStage*>(stage))
+        shrinkStage->setShrinkFactor(defaultShrinkFactor);
+    if (ClipStage* clipStage = dynamic_cast<ClipStage*>(stage)) {
+        clipStage->setPlane(defaultClipOrigin, defaultClipNormal);
+        clipStage->setCapping(defaultClipCapping);
+    }
+    return stage;
+}
 
-    mapper->SetInputConnection(geometryFilter->GetOutputPort());
+/**
+ * @brief Shows the output of the part's filter pipeline.
+ * @param output The pipeline output, the unfiltered geometry if no filter is on.
+ * @return True if the part now looks different.
+ */
+bool ModelPart::showFiltered(vtkSmartPointer<vtkPolyData> output) {
+    if (file == nullptr || output == nullptr || shown == output)
+        return false;
+
+    showGeometry(output);
+    notifyChange(PartChangeNotifier::Geometry);
+    return true;
+}
+
+/**
+ * @brief Draws full resolution geometry in place of whatever was drawn.
+ *
+ * Levels of detail belong to the geometry they were made from, so they
+ * are dropped until new ones have been made.
+ *
+ * @param data The loaded geometry or a filter output.
+ */
+void ModelPart::showGeometry(vtkPolyData* data) {
+    shown = data;
+    lods.clear();
+    lodLevel = 0;
+
+    if (data == getGeometry())
+        mapper->SetInputConnection(file->GetOutputPort());
+    else
+        mapper->SetInputDataObject(data);
     actor->SetMapper(mapper);
 }
+
+vtkPolyData* ModelPart::getShownGeometry() const {
+    return shown;
+}
+
+bool ModelPart::setLevelsOfDetail(vtkPolyData* source, const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    if (source == nullptr || source != shown)
+        return false;
+
+    showLevelOfDetail(0);
+    lods = levels;
+    notifyChange(PartChangeNotifier::LevelsOfDetail);
+    return true;
+}
+
+int ModelPart::getLevelOfDetailCount() const {
+    return lods.size() + 1;
+}
+
+vtkIdType ModelPart::getLevelOfDetailCells(int level) const {
+    if (level > 0 && level <= lods.size())
+        return lods[level - 1]->GetNumberOfCells();
+    return shown != nullptr ? shown->GetNumberOfCells() : 0;
+}
+
+/**
+ * @brief Switches the mapper to a level of detail.
+ *
+ * Only the mapper input changes, the part is not reported as changed
+ * since this happens while rendering.
+ *
+ * @param level 0 for full resolution, higher for coarser.
+ */
+void ModelPart::showLevelOfDetail(int level) {
+    level = qBound(0, level, int(lods.size()));
+    if (level == lodLevel || shown == nullptr)
+        return;
+
+    lodLevel = level;
+    if (level > 0)
+        mapper->SetInputDataObject(lods[level - 1]);
+    else if (shown == getGeometry())
+        mapper->SetInputConnection(file->GetOutputPort());
+    else
+        mapper->SetInputDataObject(shown);
+}
 /**
  * @brief Gets the name of the model part.
  *
@@ -248,6 +686,14 @@ const bool ModelPart::getVisibility(void) {
     return isVisible;
 }
 
+bool ModelPart::isShown() {
+    for (ModelPart* p = this; p->parentItem() != nullptr; p = p->parentItem()) {
+        if (!p->getVisibility())
+            return false;
+    }
+    return true;
+}
+
 /**
  * @brief Gets the actor of the model part.
  *
@@ -257,24 +703,54 @@ const vtkSmartPointer<vtkActor> ModelPart::getActor() {
     return actor;
 }
 
-vtkActor* ModelPart::getNewActor() {
+/**
+ * @brief Makes an actor for the VR thread that draws the same geometry.
+ *
+ * The geometry's arrays are shared rather than copied, so this costs the
+ * same for any size of part. The actor, mapper, property and section
+ * plane are the actor's own, and it is reference counted like any other
+ * VTK object, so it is freed once the VR scene lets go of it.
+ *
+ * @return The new actor, or nullptr if the geometry has not been loaded.
+ */
+vtkSmartPointer<vtkActor> ModelPart::getNewActor() {
 
     if (file == nullptr) {
         qDebug() << "ERROR: nothing in file reader";
         return nullptr;
     }                                                   // NULL check before assignment, potential fix?
-    pd = vtkSmartPointer<vtkPolyData>::New();
-    pd->DeepCopy(mapper->GetInputDataObject(0, 0));
-    /* 1. Create new mapper */
-    vrMapper = vtkSmartPointer<vtkDataSetMapper>::New();
-    vrMapper->SetInputDataObject(pd);
-    vrActor = vtkActor::New();
+    /* 1. Create new mapper, drawing the full resolution geometry whichever level of detail is drawn here */
+    vtkSmartPointer<vtkPolyDataMapper> vrMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    vrMapper->SetInputData(getSharedGeometry());
+    /* The VR thread gets its own copy of the section plane, the GUI's one
+     * can move while VR is rendering */
+    if (sectionPlane != nullptr) {
+        vtkSmartPointer<vtkPlane> vrPlane = vtkSmartPointer<vtkPlane>::New();
+        vrPlane->SetOrigin(sectionPlane->GetOrigin());
+        vrPlane->SetNormal(sectionPlane->GetNormal());
+        vrMapper->AddClippingPlane(vrPlane);
+    }
+    /* The property is copied, the GUI thread keeps changing its own */
+    vtkSmartPointer<vtkProperty> vrProperty = vtkSmartPointer<vtkProperty>::New();
+    vrProperty->DeepCopy(actor->GetProperty());
+    vtkSmartPointer<vtkActor> vrActor = vtkSmartPointer<vtkActor>::New();
     vrActor->SetMapper(vrMapper);
-    vrActor->SetProperty(actor->GetProperty());
+    vrActor->SetProperty(vrProperty);
     /* The new vtkActor pointer must be returned here */
     return vrActor;
 }
 
+vtkSmartPointer<vtkPolyData> ModelPart::getSharedGeometry() const {
+    return SharedGeometry::share(shown);
+}
+
+QList<vtkSmartPointer<vtkPolyData>> ModelPart::getSharedLevelsOfDetail() const {
+    QList<vtkSmartPointer<vtkPolyData>> shared;
+    for (const vtkSmartPointer<vtkPolyData>& level : lods)
+        shared.append(SharedGeometry::share(level));
+    return shared;
+}
+
 void ModelPart::setTopLevelBool(bool topLevelBool)
 {
     topLevel = topLevelBool;
@@ -288,14 +764,27 @@ bool ModelPart::getTopLevelBool() const
 QVector3D ModelPart::getOriginalPosition() const {
     return originalPosition;
 }
+QVector3D ModelPart::getPosition() const {
+    return QVector3D(actor->GetPosition()[0], actor->GetPosition()[1], actor->GetPosition()[2]);
+}
 void ModelPart::setPosition(const QVector3D& newPosition) {
     position = newPosition;
     actor->SetPosition(position.x(), position.y(), position.z());
+    notifyChange(PartChangeNotifier::Position);
 }
 void ModelPart::resetToOriginalPosition() {
     actor->SetPosition(originalPosition.x(), originalPosition.y(), originalPosition.z());
+    notifyChange(PartChangeNotifier::Position);
 }
 
 void ModelPart::resetPosition() {
     setPosition(originalPosition);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Reports a change to the part, to be sent out with the next batch.
+ * @param properties What changed.
+ */
+void ModelPart::notifyChange(PartChangeNotifier::Properties properties) {
+    PartChangeNotifier::instance()->changed(this, properties);
+}
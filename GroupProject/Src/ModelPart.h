@@ -17,9 +17,14 @@
 #include <vtkSmartPointer.h>
 #include <vtkMapper.h>
 #include <vtkActor.h>
-#include <vtkSTLReader.h>
+#include <vtkTrivialProducer.h>
+#include <vtkPolyData.h>
 #include <vtkColor.h>
+#include <vtkPlane.h>
 #include <QVector3D>
+#include "FilterPipeline.h"
+#include "FilterStages.h"
+#include "PartChangeNotifier.h"
 
 /* VTK headers - will be needed when VTK used in next worksheet,
  * commented out for now
@@ -31,6 +36,13 @@
 
 class ModelPart {
 public:
+    /** Whether the part's geometry has arrived from its file */
+    enum LoadState {
+        Loaded,         /**< Has its geometry, or has no file to load */
+        Loading,        /**< Waiting for its file to be read */
+        NotLoaded       /**< Loading was cancelled or failed, it can be loaded again */
+    };
+
     /** Constructor
      * @param data is a List (array) of strings for each property of this item (part name and visiblity in our case
      * @param parent is the parent of this item (one level up in tree)
@@ -47,6 +59,10 @@ public:
       */
     void appendChild(ModelPart* item);
 
+    /** Delete all children of this item (and their children)
+      */
+    void deleteChildren();
+
     /** Return child at position 'row' below this item
       * @param row is the row number (below this item)
       * @return pointer to the item requested.
@@ -105,10 +121,113 @@ public:
       */
     void setVisible(bool state);
 	
-	/** Load STL file
+    /** Read an STL file into a new polydata object. This does not touch any
+      * ModelPart state so it is safe to call from a worker thread.
+      * @param fileName
+      * @return the geometry, or nullptr if the file could not be read
+      */
+    static vtkSmartPointer<vtkPolyData> readSTL(const QString& fileName);
+
+    /** Set the tolerance used to weld duplicate STL vertices into shared ones
+      * @param tolerance is the largest distance between merged points, 0 merges only identical points
+      */
+    static void setWeldTolerance(double tolerance);
+
+    /** Get the tolerance used to weld duplicate STL vertices
+      * @return the largest distance between merged points
+      */
+    static double getWeldTolerance();
+
+    /** Install geometry that has already been read (e.g. by a background loader)
+      * @param data is the polydata to render for this part
+      */
+    void setGeometry(vtkSmartPointer<vtkPolyData> data);
+
+    /** Get the file the part's geometry was loaded from
+      * @return the file name, empty if nothing has been loaded
+      */
+    QString getFileName() const;
+
+    /** Get whether the part's geometry has been loaded
+      * @return the load state
+      */
+    LoadState getLoadState() const;
+
+    /** Record that the part's geometry is being loaded or could not be,
+      * setGeometry() marks it loaded
+      * @param state is the new load state
+      */
+    void setLoadState(LoadState state);
+
+    /** Set the file the part's geometry comes from
+      * @param fileName is the path of the STL file
+      */
+    void setFileName(const QString& fileName);
+
+    /** Get the loaded geometry if the part can be drawn as one instance of
+      * geometry shared with other parts (i.e. no filters are switched on)
+      * @return the shared geometry, or nullptr
+      */
+    vtkPolyData* getInstanceGeometry() const;
+
+    /** Get the geometry as loaded, before any filters are applied
+      * @return the geometry, or nullptr if it has not been loaded
+      */
+    vtkPolyData* getGeometry() const;
+
+    /** Get the full resolution geometry currently shown, i.e. the loaded or
+      * filtered geometry, whichever level of detail is drawn
+      * @return the geometry, or nullptr while only a proxy is shown
+      */
+    vtkPolyData* getShownGeometry() const;
+
+    /** Give the part coarser copies of the geometry it shows, ignored if
+      * the part has moved on to other geometry since they were made. The
+      * part reports a LevelsOfDetail change, so VR gets them too.
+      * @param source is the geometry the levels were made from
+      * @param levels are the coarser copies, finest first
+      * @return true if the levels were taken
+      */
+    bool setLevelsOfDetail(vtkPolyData* source, const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** Get the number of levels of detail, including the full resolution
+      * @return 1 if the part has no coarser copies
+      */
+    int getLevelOfDetailCount() const;
+
+    /** Get the number of cells drawn at a level of detail
+      * @param level is 0 for full resolution, higher for coarser
+      * @return the number of cells
+      */
+    vtkIdType getLevelOfDetailCells(int level) const;
+
+    /** Draw the part at a level of detail, cheap enough to call every frame
+      * @param level is 0 for full resolution, higher for coarser
+      */
+    void showLevelOfDetail(int level);
+
+    /** Show cheap stand-in geometry until the real geometry has been loaded
+      * @param data is the proxy geometry, e.g. from readProxy()
+      */
+    void setProxy(vtkSmartPointer<vtkPolyData> data);
+
+    /** Show the outline of a box until the geometry has been loaded
+      * @param bounds is xmin, xmax, ymin, ymax, zmin, zmax
+      */
+    void setProxyBounds(const double bounds[6]);
+
+    /** Read a coarse sample of an STL file's triangles to use as a proxy.
+      * Safe to call from a worker thread.
       * @param fileName
+      * @return the sampled geometry, or nullptr if the file cannot be sampled
       */
-    void loadSTL(QString fileName);
+    static vtkSmartPointer<vtkPolyData> readProxy(const QString& fileName);
+
+    /** Get the bounding box of the geometry, or of the proxy if the geometry is not loaded yet
+      * @param bounds receives xmin, xmax, ymin, ymax, zmin, zmax
+      * @return false if there is no geometry or proxy
+      */
+    bool getBounds(double bounds[6]) const;
 
     /**
      * Set the name of the ModelPart.
@@ -122,11 +241,114 @@ public:
      */
     const QColor getColor(void);
 
+    /** Switch the shrink filter on or off, for each child of a top level item.
+      * Every shrink stage in the part's filter stack is switched, and one is
+      * added to the end of the stack if there is none to switch on.
+      * Only the setting is changed, run getFilters() on a FilterRunner and
+      * pass the result to showFiltered() to show it.
+      * @param filterFlag is true to shrink
+      */
     void shrink(const bool filterFlag);
 
+    /** Switch the clip filter on or off, for each child of a top level item.
+      * Works on the clip stages of the filter stack as shrink() does.
+      * @param filterFlag is true to clip
+      */
     void clip(const bool filterFlag);
 
-    void applyFilters();
+    /** Set whether the clip filter closes its cut, for this part and every part below it.
+      * Only the setting is changed, as for clip().
+      * @param cap is true to fill the cut
+      */
+    void setClipCapping(bool cap);
+
+    /** Set whether the clip filter of parts created from now on closes its cut
+      * @param cap is true to fill the cut
+      */
+    static void setDefaultClipCapping(bool cap);
+
+    /** Set the shrink factor, for this part and every part below it.
+      * Only the setting is changed, as for shrink().
+      * @param factor is 1 for the original size down to 0.01, smaller values are clamped to 0.01
+      */
+    void setShrinkFactor(double factor);
+
+    /** Set the shrink factor of parts created from now on
+      * @param factor is the shrink factor
+      */
+    static void setDefaultShrinkFactor(double factor);
+
+    /** Set the clip plane, for this part and every part below it.
+      * Only the setting is changed, as for clip().
+      * @param origin is a point on the plane
+      * @param normal points towards the side that is kept
+      */
+    void setClipPlane(const double origin[3], const double normal[3]);
+
+    /** Set the clip plane of parts created from now on
+      * @param origin is a point on the plane
+      * @param normal points towards the side that is kept
+      */
+    static void setDefaultClipPlane(const double origin[3], const double normal[3]);
+
+    /** Cut the part open at render time with a clipping plane, for this part
+      * and every part below it. Unlike the clip filter this costs no geometry
+      * processing, moving the plane only needs a re-render and a call to
+      * sectionPlaneMoved() so copies of it, e.g. in VR, can follow.
+      * @param plane is the plane, shared with other parts, nullptr to stop sectioning
+      */
+    void setSectionPlane(vtkPlane* plane);
+
+    /** Report a Section change for every part cut open with a plane, after
+      * the plane has been moved in place
+      * @param plane is the plane that moved
+      */
+    static void sectionPlaneMoved(vtkPlane* plane);
+
+    /** Get the plane the part is cut open with at render time
+      * @return the plane, nullptr if the part is not sectioned
+      */
+    vtkPlane* getSectionPlane() const;
+
+    /** Set the plane that parts created from now on are sectioned with
+      * @param plane is the plane, which must outlive the parts, nullptr for none
+      */
+    static void setDefaultSectionPlane(vtkPlane* plane);
+
+    /** Get the part's filter pipeline
+      * @return the pipeline, owned by the part
+      */
+    FilterPipeline* getFilters();
+
+    /** Replace the filter stack of this part and every part below it with
+      * copies of the stages of another pipeline. Only the settings are
+      * changed, as for shrink().
+      * @param source is the pipeline to copy, e.g. another part's filters
+      */
+    void setFilterStack(const FilterPipeline* source);
+
+    /** Make a filter stage with the settings new parts are given, e.g. the
+      * current shrink factor and clip plane
+      * @param name is one of FilterStages::names()
+      * @return the new stage, or nullptr if the name is not known
+      */
+    static FilterStage* createFilterStage(const QString& name);
+
+    /** Show the output of the part's filter pipeline
+      * @param output is the filtered geometry
+      * @return true if the part now looks different
+      */
+    bool showFiltered(vtkSmartPointer<vtkPolyData> output);
+
+    /** Get whether a shrink stage is switched on for this part
+      * @return true if shrunk
+      */
+    bool getShrinkStatus() const;
+
+    /** Get whether a clip stage is switched on for this part
+      * @return true if clipped
+      */
+    bool getClipStatus() const;
 
     /**
      * Get the name of the ModelPart.
@@ -140,15 +362,33 @@ public:
      */
     const bool getVisibility(void);
 
+    /** Check whether the part is drawn, which needs it and every part above
+      * it to be visible. The root item's own visibility is not used.
+      * @return true if shown
+      */
+    bool isShown();
+
     /** Return actor
       * @return pointer to default actor for GUI rendering
       */
     const vtkSmartPointer<vtkActor> getActor();
 
-    /** Return new actor for use in VR
-      * @return pointer to new actor
+    /** Return new actor for use in VR, sharing the part's geometry
+      * @return the new actor
       */
-    vtkActor* getNewActor();
+    vtkSmartPointer<vtkActor> getNewActor();
+
+    /** Return the full resolution geometry the part shows, for use in VR.
+      * The arrays are shared with the part, not copied.
+      * @return the shared geometry, or nullptr while only a proxy is shown
+      */
+    vtkSmartPointer<vtkPolyData> getSharedGeometry() const;
+
+    /** Return the part's levels of detail for use in VR, to go with the
+      * actor from getNewActor(). The arrays are shared, not copied.
+      * @return the levels, finest first, empty if the part has none
+      */
+    QList<vtkSmartPointer<vtkPolyData>> getSharedLevelsOfDetail() const;
 
     void setTopLevelBool(bool topLevelBool);
 
@@ -156,6 +396,8 @@ public:
 
     QVector3D getOriginalPosition() const;
 
+    QVector3D getPosition() const;
+
     void setPosition(const QVector3D& newPosition);
 
     void resetToOriginalPosition();
@@ -163,27 +405,40 @@ public:
     void resetPosition();
     
 private:
+    /** Report a change to this part, it is sent out with the next batch
+      * @param properties are what changed
+      */
+    void notifyChange(PartChangeNotifier::Properties properties);
+
+    /** Draw full resolution geometry, dropping the levels made from the old one */
+    void showGeometry(vtkPolyData* data);
+
     QList<ModelPart*>                           m_childItems;       /**< List (array) of child items */
     QList<QVariant>                             m_itemData;         /**< List (array of column data for item */
     ModelPart*                                  m_parentItem;       /**< Pointer to parent */
     bool                                        topLevel = false;   /**< True if this is a top level item */
 
-    bool                                        isVisible;          /**< True/false to indicate if should be visible in model rendering */
+    bool                                        isVisible = true;   /**< True/false to indicate if should be visible in model rendering */
     QColor                       Colour = Qt::GlobalColor::white;   /**< Colour of the part */
     QString                                     Name;               /**< Name of the part */ 
 	
-	vtkSmartPointer<vtkSTLReader>               file;               /**< Datafile from which part loaded */
+	vtkSmartPointer<vtkTrivialProducer>         file;               /**< Producer for the geometry loaded from file */
+    QString                                     sourceFile;         /**< Path of the file the part was loaded from */
+    LoadState                                   loadState = Loaded; /**< Whether the geometry from sourceFile has arrived */
     vtkSmartPointer<vtkMapper>                  mapper;             /**< Mapper for rendering */
     vtkSmartPointer<vtkActor>                   actor;              /**< Actor for rendering */
-    vtkActor*                                   vrActor;            /**< Actor for rendering in VR */
-    vtkSmartPointer<vtkPolyData>                pd;                 /**< Polydata for  VR rendering */
-    vtkSmartPointer<vtkMapper>                  vrMapper;           /**< Mapper for VR rendering */
 
     QVector3D                                   originalPosition;   /*Member Variable to store original position*/
     QVector3D                                   position;           /*Member Variable to store current position*/
 
-    bool shrinkStatus = false;
-    bool clipStatus = false;
+    FilterPipeline                              filters;            /**< The part's filter stack, kept between toggles */
+
+    vtkSmartPointer<vtkPolyData>                proxy;              /**< Stand-in shown until the geometry is loaded */
+    vtkSmartPointer<vtkPlane>                   sectionPlane;       /**< Render-time clipping plane, nullptr if not sectioned */
+
+    vtkSmartPointer<vtkPolyData>                shown;              /**< Full resolution geometry drawn, nullptr while a proxy is */
+    QList<vtkSmartPointer<vtkPolyData>>         lods;               /**< Coarser copies of shown, finest first */
+    int                                         lodLevel = 0;       /**< Level drawn, 0 for shown itself */
 
 
 
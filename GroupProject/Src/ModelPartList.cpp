@@ -15,6 +15,9 @@ ModelPartList::ModelPartList( const QString& data, QObject* parent ) : QAbstract
      * acts as the column headers
      */
     rootItem = new ModelPart( { tr("Part"), tr("Visible?") } );
+
+    /* Refresh the rows of parts whose name, visibility or load state has changed */
+    connect( PartChangeNotifier::instance(), &PartChangeNotifier::partsChanged, this, &ModelPartList::partsChanged );
 }
 
 ModelPartList::~ModelPartList() {
@@ -38,12 +41,21 @@ QVariant ModelPartList::data( const QModelIndex& index, int role ) const {
     /* Role represents what this data will be used for, we only need deal with the case
      * when QT is asking for data to create and display the treeview. Return a new,
      * empty QVariant if any other request comes through. */
-    if (role != Qt::DisplayRole)
-        return QVariant();
-
     /* Get a a pointer to the item referred to by the QModelIndex */
     ModelPart* item = static_cast<ModelPart*>( index.internalPointer() );
 
+    /* Parts whose geometry is still on its way, or never arrived, are greyed out */
+    if( item->getLoadState() != ModelPart::Loaded && index.column() == 0 ) {
+        if( role == Qt::ForegroundRole )
+            return QColor( Qt::gray );
+        if( role == Qt::ToolTipRole )
+            return item->getLoadState() == ModelPart::Loading ? tr( "Loading..." )
+                : tr( "Not loaded, use Load Missing Parts to try again" );
+    }
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
     /* Each item in the tree has a number of columns ("Part" and "Visible" in this 
      * initial example) return the column requested by the QModelIndex */
     return item->data( index.column() );
@@ -142,3 +154,78 @@ QModelIndex ModelPartList::appendChild(QModelIndex& parent, const QList<QVariant
     return child;
 }
 
+
+QModelIndex ModelPartList::appendPart( const QModelIndex& parent, ModelPart* part ) {
+    ModelPart* parentPart;
+
+    if( parent.isValid() )
+        parentPart = static_cast<ModelPart*>(parent.internalPointer());
+    else
+        parentPart = rootItem;
+
+    int row = parentPart->childCount();
+
+    beginInsertRows( parent, row, row );
+    parentPart->appendChild( part );
+    endInsertRows();
+
+    PartChangeNotifier::instance()->changed( part, PartChangeNotifier::Inserted );
+
+    return index( row, 0, parent );
+}
+
+
+void ModelPartList::appendParts( const QModelIndex& parent, const QList<ModelPart*>& parts ) {
+    if( parts.isEmpty() )
+        return;
+
+    ModelPart* parentPart;
+
+    if( parent.isValid() )
+        parentPart = static_cast<ModelPart*>(parent.internalPointer());
+    else
+        parentPart = rootItem;
+
+    int first = parentPart->childCount();
+
+    beginInsertRows( parent, first, first + parts.size() - 1 );
+    for( ModelPart* part : parts )
+        parentPart->appendChild( part );
+    endInsertRows();
+
+    for( ModelPart* part : parts )
+        PartChangeNotifier::instance()->changed( part, PartChangeNotifier::Inserted );
+}
+
+
+void ModelPartList::setParts( const QList<ModelPart*>& parts ) {
+    beginResetModel();
+
+    rootItem->deleteChildren();
+    for( ModelPart* part : parts )
+        rootItem->appendChild( part );
+
+    endResetModel();
+
+    for( ModelPart* part : parts )
+        PartChangeNotifier::instance()->changed( part, PartChangeNotifier::Inserted );
+}
+
+
+void ModelPartList::partsChanged( const PartChangeNotifier::Changes& changes ) {
+    for( auto it = changes.constBegin(); it != changes.constEnd(); ++it ) {
+        if( !(it.value() & (PartChangeNotifier::Name | PartChangeNotifier::Visibility | PartChangeNotifier::LoadState)) )
+            continue;
+
+        /* Parts not yet added to this tree have no row to refresh */
+        ModelPart* part = it.key();
+        ModelPart* top = part;
+        while( top->parentItem() != nullptr )
+            top = top->parentItem();
+        if( top != rootItem || part == rootItem )
+            continue;
+
+        int row = part->row();
+        emit dataChanged( createIndex( row, 0, part ), createIndex( row, 1, part ) );
+    }
+}
@@ -12,6 +12,7 @@
 
 
 #include "ModelPart.h"
+#include "PartChangeNotifier.h"
 
 #include <QAbstractItemModel>
 #include <QModelIndex>
@@ -95,6 +96,34 @@ public:
       */
     QModelIndex appendChild( QModelIndex& parent, const QList<QVariant>& data );
 
+    /** Add an already created part as the last child of parent, notifying
+      * any attached views of the new row.
+      * @param parent is the index of the item to add to, the tree root if invalid
+      * @param part is the new item (must already be allocated using new)
+      * @return index of the new item
+      */
+    QModelIndex appendPart( const QModelIndex& parent, ModelPart* part );
+
+    /** Add several already created parts (with their children) below parent.
+      * Attached views get a single insert notification for the whole batch
+      * rather than one per row, so large imports do not flood the tree view.
+      * @param parent is the index of the item to add to, the tree root if invalid
+      * @param parts are the new items (already allocated using new)
+      */
+    void appendParts( const QModelIndex& parent, const QList<ModelPart*>& parts );
+
+    /** Replace the whole tree with a new set of top level items.
+      * Attached views are reset once rather than notified row by row.
+      * @param parts are the new top level items (already allocated using new, children included)
+      */
+    void setParts( const QList<ModelPart*>& parts );
+
+private slots:
+    /** Tell attached views about parts whose name or visibility has changed
+      * @param changes are the parts changed and what changed about each
+      */
+    void partsChanged( const PartChangeNotifier::Changes& changes );
+
 
 
 private:
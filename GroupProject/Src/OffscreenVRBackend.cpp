@@ -0,0 +1,143 @@
+/**     @file OffscreenVRBackend.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Stands in for the headset so the VR thread can be run and timed on a
+  *     machine without one, e.g. in CI with software OpenGL.
+  */
+
+#include "OffscreenVRBackend.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+/* One eye's display, typical of current headsets */
+static const int eyeWidth = 1440;
+static const int eyeHeight = 1600;
+
+/* Frames per log line, a second at the headset's refresh rate */
+static const int framesPerLog = 90;
+
+/* How far and how fast the synthetic head turns, degrees and seconds per cycle */
+static const double yawDegrees = 30.0;
+static const double yawPeriod = 8.0;
+static const double pitchDegrees = 10.0;
+static const double pitchPeriod = 5.0;
+
+/* Headsets do not report a view angle through the camera, this is typical */
+static const double headsetViewAngle = 100.0;
+
+OffscreenVRBackend::OffscreenVRBackend(int frameLimit, bool moveHead)
+    : frameLimit(frameLimit), moveHead(moveHead) {
+}
+
+vtkRenderer* OffscreenVRBackend::createRenderer() {
+    renderer = vtkSmartPointer<vtkRenderer>::New();
+    return renderer;
+}
+
+void OffscreenVRBackend::start() {
+    /* The left eye is drawn in the left half of the buffer, the right eye in the right */
+    window = vtkSmartPointer<vtkRenderWindow>::New();
+    window->SetOffScreenRendering(1);
+    window->SetSize(2 * eyeWidth, eyeHeight);
+    window->SetStereoTypeToSplitViewportHorizontal();
+    window->StereoRenderOn();
+    window->AddRenderer(renderer);
+
+    camera = vtkSmartPointer<vtkCamera>::New();
+    camera->SetViewAngle(headsetViewAngle);
+    renderer->SetActiveCamera(camera);
+    rest = vtkSmartPointer<vtkCamera>::New();
+    frameScene();
+
+    qInfo() << "Offscreen VR started," << 2 * eyeWidth << "x" << eyeHeight << "stereo";
+    started = std::chrono::steady_clock::now();
+    window->Render();
+}
+
+/**
+ * @brief Moves the head and draws one frame, timing the draw.
+ *
+ * Only the draw is timed, as the headset's frame time would be. It is the
+ * same time the frame governor sees, so the two can be compared.
+ */
+void OffscreenVRBackend::doOneEvent() {
+    /* Actors may only arrive once the session is running */
+    if (!framed)
+        frameScene();
+
+    auto now = std::chrono::steady_clock::now();
+    if (moveHead)
+        setHeadPose(std::chrono::duration<double>(now - started).count());
+
+    window->Render();
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+
+    frames++;
+    total += milliseconds;
+    worst = std::max(worst, milliseconds);
+    periodFrames++;
+    periodTotal += milliseconds;
+    periodWorst = std::max(periodWorst, milliseconds);
+
+    if (periodFrames == framesPerLog) {
+        qInfo() << "Offscreen VR frames" << frames - periodFrames + 1 << "to" << frames
+                << "mean" << periodTotal / periodFrames << "ms, worst" << periodWorst << "ms";
+        periodFrames = 0;
+        periodTotal = 0.0;
+        periodWorst = 0.0;
+    }
+}
+
+bool OffscreenVRBackend::done() const {
+    return frameLimit > 0 && frames >= frameLimit;
+}
+
+void OffscreenVRBackend::finish() {
+    /* The VR thread is about to end, let go of the context it made current */
+    if (window != nullptr)
+        window->ReleaseCurrent();
+
+    if (frames == 0)
+        return;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    qInfo() << "Offscreen VR ended after" << frames << "frames in" << seconds << "s, mean"
+            << total / frames << "ms, worst" << worst << "ms";
+}
+
+int OffscreenVRBackend::frameCount() const {
+    return frames;
+}
+
+double OffscreenVRBackend::meanMilliseconds() const {
+    return frames > 0 ? total / frames : 0.0;
+}
+
+double OffscreenVRBackend::worstMilliseconds() const {
+    return worst;
+}
+
+vtkRenderWindow* OffscreenVRBackend::getRenderWindow() const {
+    return window;
+}
+
+/* Turns the head from side to side and up and down about where it started,
+ * on two periods that do not line up so the view does not repeat exactly */
+void OffscreenVRBackend::setHeadPose(double seconds) {
+    const double pi = 3.14159265358979323846;
+
+    camera->DeepCopy(rest);
+    camera->Yaw(yawDegrees * std::sin(2.0 * pi * seconds / yawPeriod));
+    camera->Pitch(pitchDegrees * std::sin(2.0 * pi * seconds / pitchPeriod));
+    camera->OrthogonalizeViewUp();
+    renderer->ResetCameraClippingRange();
+}
+
+void OffscreenVRBackend::frameScene() {
+    framed = renderer->VisibleActorCount() > 0;
+    renderer->ResetCamera();
+    rest->DeepCopy(camera);
+}
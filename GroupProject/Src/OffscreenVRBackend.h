@@ -0,0 +1,92 @@
+/**     @file OffscreenVRBackend.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Stands in for the headset so the VR thread can be run and timed on a
+  *     machine without one, e.g. in CI with software OpenGL.
+  */
+
+#ifndef VIEWER_OFFSCREENVRBACKEND_H
+#define VIEWER_OFFSCREENVRBACKEND_H
+
+#include "VRBackend.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkCamera.h>
+#include <vtkRenderWindow.h>
+
+#include <chrono>
+
+/* Draws both eyes side by side into an offscreen buffer the size of a
+ * headset's two displays, with no window and no interactor. The head is
+ * made to look slowly around the scene, so levels of detail and culling
+ * change as they would with someone wearing the headset. Nothing paces the
+ * loop, each frame is drawn as soon as the last one is done, and the time
+ * taken is logged every second's worth of headset frames and at the end. */
+class OffscreenVRBackend : public VRBackend {
+public:
+    /** Constructor
+      * @param frameLimit is the number of frames to draw before ending the
+      *        session, 0 to run until stopped
+      * @param moveHead is false to keep looking straight at the scene, so
+      *        what is drawn where is known
+      */
+    OffscreenVRBackend(int frameLimit = 0, bool moveHead = true);
+
+    vtkRenderer* createRenderer() override;
+    void start() override;
+    void doOneEvent() override;
+    bool done() const override;
+    void finish() override;
+
+    /** Get the number of frames drawn so far
+      * @return the frame count
+      */
+    int frameCount() const;
+
+    /** Get the mean time taken to draw a frame
+      * @return milliseconds, 0 before the first frame
+      */
+    double meanMilliseconds() const;
+
+    /** Get the longest time taken to draw a frame
+      * @return milliseconds, 0 before the first frame
+      */
+    double worstMilliseconds() const;
+
+    /** Get the window both eyes are drawn into, the left eye in the left
+      * half. Its context is released once the session ends, so another
+      * thread can then read back the last frame.
+      * @return the window, nullptr before start()
+      */
+    vtkRenderWindow* getRenderWindow() const;
+
+private:
+    /** Point the camera where the synthetic head is looking at a time
+      * @param seconds is the time since the session started
+      */
+    void setHeadPose(double seconds);
+
+    /** Frame the scene and remember it as the pose the head moves about */
+    void frameScene();
+
+    vtkSmartPointer<vtkRenderWindow>        window;
+    vtkSmartPointer<vtkRenderer>            renderer;
+    vtkSmartPointer<vtkCamera>              camera;
+    vtkSmartPointer<vtkCamera>              rest;               /**< Head pose before any movement */
+    bool                                    framed = false;     /**< Set once there was something to frame */
+
+    int                                     frameLimit;
+    bool                                    moveHead;
+    int                                     frames = 0;
+    std::chrono::steady_clock::time_point   started;
+
+    /* Frame times, milliseconds, over the current log period and the session */
+    double                                  periodTotal = 0.0;
+    double                                  periodWorst = 0.0;
+    int                                     periodFrames = 0;
+    double                                  total = 0.0;
+    double                                  worst = 0.0;
+};
+
+#endif
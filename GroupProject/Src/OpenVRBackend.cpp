@@ -0,0 +1,43 @@
+/**     @file OpenVRBackend.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Draws the VR scene in a headset through SteamVR.
+  */
+
+#include "OpenVRBackend.h"
+
+vtkRenderer* OpenVRBackend::createRenderer() {
+    renderer = vtkSmartPointer<vtkOpenVRRenderer>::New();
+    return renderer;
+}
+
+void OpenVRBackend::start() {
+    /* The render window is the actual GUI window
+     * that appears on the computer screen
+     */
+    window = vtkSmartPointer<vtkOpenVRRenderWindow>::New();
+    window->Initialize();
+    window->AddRenderer(renderer);
+
+    /* Create Open VR Camera */
+    camera = vtkSmartPointer<vtkOpenVRCamera>::New();
+    renderer->SetActiveCamera(camera);
+
+    /* The render window interactor captures mouse events
+     * and will perform appropriate camera or actor manipulation
+     * depending on the nature of the events.
+     */
+    interactor = vtkSmartPointer<vtkOpenVRRenderWindowInteractor>::New();
+    interactor->SetRenderWindow(window);
+    interactor->Initialize();
+    window->Render();
+}
+
+void OpenVRBackend::doOneEvent() {
+    interactor->DoOneEvent(window, renderer);
+}
+
+bool OpenVRBackend::done() const {
+    return interactor->GetDone();
+}
@@ -0,0 +1,35 @@
+/**     @file OpenVRBackend.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Draws the VR scene in a headset through SteamVR.
+  */
+
+#ifndef VIEWER_OPENVRBACKEND_H
+#define VIEWER_OPENVRBACKEND_H
+
+#include "VRBackend.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkOpenVRRenderWindow.h>
+#include <vtkOpenVRRenderWindowInteractor.h>
+#include <vtkOpenVRRenderer.h>
+#include <vtkOpenVRCamera.h>
+
+/* The headset sets the camera from its own pose and paces the loop to its
+ * refresh rate. Only built with ENABLE_OPENVR. */
+class OpenVRBackend : public VRBackend {
+public:
+    vtkRenderer* createRenderer() override;
+    void start() override;
+    void doOneEvent() override;
+    bool done() const override;
+
+private:
+    vtkSmartPointer<vtkOpenVRRenderWindow>              window;
+    vtkSmartPointer<vtkOpenVRRenderWindowInteractor>    interactor;
+    vtkSmartPointer<vtkOpenVRRenderer>                  renderer;
+    vtkSmartPointer<vtkOpenVRCamera>                    camera;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/**     @file PartChangeNotifier.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Collects changes made to model parts and hands them out in one batch
+  *     per pass of the event loop, with a flag for each property changed.
+  */
+
+#include "PartChangeNotifier.h"
+
+#include <QTimer>
+
+PartChangeNotifier* PartChangeNotifier::instance() {
+    static PartChangeNotifier notifier;
+    return &notifier;
+}
+
+void PartChangeNotifier::changed(ModelPart* part, Properties properties) {
+    pending[part] |= properties;
+
+    if (scheduled)
+        return;
+    scheduled = true;
+    QTimer::singleShot(0, this, &PartChangeNotifier::flush);
+}
+
+void PartChangeNotifier::forget(ModelPart* part) {
+    pending.remove(part);
+}
+
+/**
+ * @brief Sends the recorded changes.
+ *
+ * The batch is taken before it is sent, so changes made by the receivers
+ * go out in the next batch rather than being lost or looping.
+ */
+void PartChangeNotifier::flush() {
+    scheduled = false;
+    if (pending.isEmpty())
+        return;
+
+    Changes changes;
+    changes.swap(pending);
+    emit partsChanged(changes);
+}
@@ -0,0 +1,76 @@
+/**     @file PartChangeNotifier.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Collects changes made to model parts and hands them out in one batch
+  *     per pass of the event loop, with a flag for each property changed.
+  */
+
+#ifndef VIEWER_PARTCHANGENOTIFIER_H
+#define VIEWER_PARTCHANGENOTIFIER_H
+
+#include <QObject>
+#include <QHash>
+
+class ModelPart;
+
+/* ModelPart setters report here, so views never have to be told about a
+ * change by hand. Any number of changes to any number of parts made while
+ * handling one event arrive together, so a burst of edits costs one tree
+ * update and one redraw. Only used on the GUI thread. */
+class PartChangeNotifier : public QObject {
+    Q_OBJECT
+public:
+    /** What changed about a part */
+    enum Property {
+        Name        = 0x01,
+        Colour      = 0x02,
+        Visibility  = 0x04,     /**< Also changes whether the parts below are shown */
+        Position    = 0x08,
+        Geometry    = 0x10,     /**< Loaded, proxy or filtered geometry shown */
+        Filters     = 0x20,     /**< Filter stack or its settings */
+        Section     = 0x40,     /**< Render-time section plane */
+        Inserted    = 0x80,     /**< Added to the tree */
+        LoadState   = 0x100,    /**< Started, finished or gave up loading its geometry */
+        LevelsOfDetail = 0x200  /**< Coarser copies of the shown geometry arrived */
+    };
+    Q_DECLARE_FLAGS(Properties, Property)
+
+    /** Changes made since the last batch, by part */
+    typedef QHash<ModelPart*, Properties> Changes;
+
+    /** Get the notifier all parts report to
+      * @return the notifier
+      */
+    static PartChangeNotifier* instance();
+
+    /** Record a change, the batch goes out once control returns to the event loop
+      * @param part is the part that changed
+      * @param properties are what changed
+      */
+    void changed(ModelPart* part, Properties properties);
+
+    /** Drop any changes recorded for a part, called when it is deleted
+      * @param part is the part
+      */
+    void forget(ModelPart* part);
+
+    /** Send the changes recorded so far now rather than later */
+    void flush();
+
+signals:
+    /** Sent once per pass of the event loop in which parts changed
+      * @param changes are the parts changed and what changed about each
+      */
+    void partsChanged(const PartChangeNotifier::Changes& changes);
+
+private:
+    PartChangeNotifier() = default;
+
+    Changes     pending;
+    bool        scheduled = false;  /**< A flush is queued */
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(PartChangeNotifier::Properties)
+
+#endif
@@ -0,0 +1,168 @@
+/**     @file ProjectFile.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Saves and restores the model tree (names, hierarchy, colours,
+  *     visibility, filters, positions and bounding boxes) as a JSON project
+  *     file. Geometry is not stored, only the path of each part's STL file.
+  */
+
+#include "ProjectFile.h"
+#include "ModelPart.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+/* Version 2 stores each part's filter stack, version 1 only had shrink and clip flags */
+static const int projectVersion = 2;
+
+static QJsonArray toJson(const QVector3D& v) {
+    return QJsonArray{ v.x(), v.y(), v.z() };
+}
+
+static QVector3D vectorFromJson(const QJsonValue& value) {
+    QJsonArray a = value.toArray();
+    return QVector3D(float(a.at(0).toDouble()), float(a.at(1).toDouble()), float(a.at(2).toDouble()));
+}
+
+static QJsonArray filtersToJson(const FilterPipeline* filters) {
+    QJsonArray stack;
+    for (int i = 0; i < filters->stageCount(); i++) {
+        FilterStage* stage = filters->stage(i);
+        QJsonArray parameters;
+        for (int p = 0; p < stage->parameterCount(); p++)
+            parameters.append(stage->parameter(p));
+
+        QJsonObject obj;
+        obj["name"] = stage->name();
+        obj["enabled"] = stage->isEnabled();
+        obj["parameters"] = parameters;
+        stack.append(obj);
+    }
+    return stack;
+}
+
+/* Stages of unknown types, e.g. from a newer version, are left out */
+static void filtersFromJson(const QJsonArray& stack, FilterPipeline* filters) {
+    filters->clearStages();
+    for (const QJsonValue& value : stack) {
+        QJsonObject obj = value.toObject();
+        FilterStage* stage = ModelPart::createFilterStage(obj["name"].toString());
+        if (stage == nullptr)
+            continue;
+
+        QJsonArray parameters = obj["parameters"].toArray();
+        for (int p = 0; p < stage->parameterCount() && p < parameters.size(); p++)
+            stage->setParameter(p, parameters.at(p).toDouble());
+        stage->setEnabled(obj["enabled"].toBool());
+        filters->appendStage(stage);
+    }
+}
+
+static QJsonObject partToJson(ModelPart* part, const QDir& projectDir) {
+    QJsonObject obj;
+    obj["name"] = part->getName();
+    obj["visible"] = part->getVisibility();
+    obj["colour"] = part->getColor().name();
+    obj["topLevel"] = part->getTopLevelBool();
+    obj["filters"] = filtersToJson(part->getFilters());
+    obj["position"] = toJson(part->getPosition());
+
+    if (!part->getFileName().isEmpty())
+        obj["file"] = projectDir.relativeFilePath(part->getFileName());
+
+    double bounds[6];
+    if (part->getBounds(bounds)) {
+        QJsonArray box;
+        for (double b : bounds)
+            box.append(b);
+        obj["bounds"] = box;
+    }
+
+    QJsonArray children;
+    for (int i = 0; i < part->childCount(); i++)
+        children.append(partToJson(part->child(i), projectDir));
+    obj["children"] = children;
+
+    return obj;
+}
+
+static ModelPart* partFromJson(const QJsonObject& obj, const QDir& projectDir) {
+    QString name = obj["name"].toString();
+    bool visible = obj["visible"].toBool(true);
+
+    ModelPart* part = new ModelPart({ name, visible ? "true" : "false" });
+    part->setName(name);
+    part->setVisible(visible);
+    part->setTopLevelBool(obj["topLevel"].toBool());
+    part->setColour(QColor(obj["colour"].toString("#ffffff")));
+    part->setPosition(vectorFromJson(obj["position"]));
+
+    if (obj.contains("file"))
+        part->setFileName(QDir::cleanPath(projectDir.absoluteFilePath(obj["file"].toString())));
+
+    QJsonArray box = obj["bounds"].toArray();
+    if (box.size() == 6) {
+        double bounds[6];
+        for (int i = 0; i < 6; i++)
+            bounds[i] = box.at(i).toDouble();
+        part->setProxyBounds(bounds);
+    }
+
+    /* Filters are switched on now but only run once the geometry arrives */
+    if (obj.contains("filters")) {
+        filtersFromJson(obj["filters"].toArray(), part->getFilters());
+    } else if (!part->getTopLevelBool()) {
+        part->shrink(obj["shrink"].toBool());
+        part->clip(obj["clip"].toBool());
+    }
+
+    for (const QJsonValue& child : obj["children"].toArray())
+        part->appendChild(partFromJson(child.toObject(), projectDir));
+
+    return part;
+}
+
+bool ProjectFile::save(const QString& fileName, ModelPart* root) {
+    QDir projectDir = QFileInfo(fileName).absoluteDir();
+
+    QJsonArray parts;
+    for (int i = 0; i < root->childCount(); i++)
+        parts.append(partToJson(root->child(i), projectDir));
+
+    QJsonObject project;
+    project["version"] = projectVersion;
+    project["parts"] = parts;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(project).toJson());
+    return file.commit();
+}
+
+bool ProjectFile::load(const QString& fileName, QList<ModelPart*>& parts) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    QJsonObject project = document.object();
+    if (project["version"].toInt() > projectVersion)
+        return false;
+
+    QDir projectDir = QFileInfo(fileName).absoluteDir();
+    for (const QJsonValue& part : project["parts"].toArray())
+        parts.append(partFromJson(part.toObject(), projectDir));
+
+    return true;
+}
@@ -0,0 +1,37 @@
+/**     @file ProjectFile.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Saves and restores the model tree (names, hierarchy, colours,
+  *     visibility, filters, positions and bounding boxes) as a JSON project
+  *     file. Geometry is not stored, only the path of each part's STL file.
+  */
+
+#ifndef VIEWER_PROJECTFILE_H
+#define VIEWER_PROJECTFILE_H
+
+#include <QList>
+#include <QString>
+
+class ModelPart;
+
+class ProjectFile {
+public:
+    /** Save the tree below root to a project file.
+      * STL paths are stored relative to the project file where possible.
+      * @param fileName is the project file to write
+      * @param root is the tree root, which itself is not saved
+      * @return false if the file could not be written
+      */
+    static bool save(const QString& fileName, ModelPart* root);
+
+    /** Load a project file. The returned parts have their settings and
+      * bounding-box proxies but no geometry, which should be loaded afterwards.
+      * @param fileName is the project file to read
+      * @param parts receives the top level items, allocated with new
+      * @return false if the file could not be read
+      */
+    static bool load(const QString& fileName, QList<ModelPart*>& parts);
+};
+
+#endif
@@ -0,0 +1,94 @@
+/**     @file STLLoader.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Reads STL files on a pool of worker threads so the GUI stays
+  *     responsive while large assemblies are imported.
+  */
+
+#include "STLLoader.h"
+#include "ModelPart.h"
+
+#include <QThread>
+
+
+STLLoader::STLLoader(QObject* parent)
+    : QObject(parent), cancelled(std::make_shared<std::atomic<bool>>(false)) {
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+STLLoader::~STLLoader() {
+    cancel();
+    pool.waitForDone();
+}
+
+void STLLoader::load(const QString& fileName, Callback onLoaded) {
+    total++;
+    emit progress(done, total);
+    queue(fileName, onLoaded, false);
+}
+
+void STLLoader::loadProxy(const QString& fileName, Callback onLoaded) {
+    queue(fileName, onLoaded, true);
+}
+
+void STLLoader::queue(const QString& fileName, Callback onLoaded, bool proxy) {
+    quint64 ticket = nextTicket++;
+    callbacks.insert(ticket, onLoaded);
+
+    /* The task only holds its own copy of the batch's cancel flag, so a cancel
+     * affects this batch but not anything queued afterwards. The callback stays
+     * here on the GUI thread and is looked up by ticket when the result arrives. */
+    std::shared_ptr<std::atomic<bool>> flag = cancelled;
+
+    /* Proxies are cheap, give them priority so everything appears quickly */
+    int priority = proxy ? 1 : 0;
+
+    pool.start([this, fileName, ticket, flag, proxy]() {
+        if (*flag)
+            return;
+
+        vtkSmartPointer<vtkPolyData> data = proxy ? ModelPart::readProxy(fileName) : ModelPart::readSTL(fileName);
+
+        /* Hand the result back to the GUI thread, VTK objects used for
+         * rendering must only be touched from there */
+        QMetaObject::invokeMethod(this, [this, data, ticket, proxy]() {
+            Callback onLoaded = callbacks.take(ticket);
+            if (!onLoaded)
+                return;
+
+            if (proxy) {
+                onLoaded(data);
+                return;
+            }
+
+            done++;
+            onLoaded(data);
+            emit progress(done, total);
+
+            if (done == total) {
+                done = 0;
+                total = 0;
+                emit finished();
+            }
+        }, Qt::QueuedConnection);
+    }, priority);
+}
+
+void STLLoader::cancel() {
+    if (callbacks.isEmpty())
+        return;
+
+    *cancelled = true;
+    cancelled = std::make_shared<std::atomic<bool>>(false);
+    pool.clear();
+    callbacks.clear();
+
+    done = 0;
+    total = 0;
+    emit finished();
+}
+
+bool STLLoader::isBusy() const {
+    return total > 0;
+}
@@ -0,0 +1,86 @@
+/**     @file STLLoader.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Reads STL files on a pool of worker threads so the GUI stays
+  *     responsive while large assemblies are imported.
+  */
+
+#ifndef VIEWER_STLLOADER_H
+#define VIEWER_STLLOADER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QThreadPool>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class STLLoader : public QObject {
+    Q_OBJECT
+public:
+    /** Function called on the GUI thread when a file has been read.
+      * The polydata is nullptr if the file could not be read.
+      */
+    typedef std::function<void(vtkSmartPointer<vtkPolyData>)> Callback;
+
+    /** Constructor
+      * @param parent is the owning QObject
+      */
+    STLLoader(QObject* parent = nullptr);
+
+    /** Destructor
+      * Cancels any outstanding loads and waits for running ones to finish
+      */
+    ~STLLoader();
+
+    /** Queue a file to be read in the background, one file per task.
+      * @param fileName is the STL file to read
+      * @param onLoaded is called on the GUI thread once the file has been read
+      */
+    void load(const QString& fileName, Callback onLoaded);
+
+    /** Queue a coarse sample of a file to be read ahead of any full loads.
+      * Proxies do not count towards progress.
+      * @param fileName is the STL file to sample
+      * @param onLoaded is called on the GUI thread with the proxy geometry
+      */
+    void loadProxy(const QString& fileName, Callback onLoaded);
+
+    /** Drop all queued files. Files that are already being read will finish
+      * but their callbacks will not be called.
+      */
+    void cancel();
+
+    /** Check whether there are any files still waiting or being read
+      * @return true if busy
+      */
+    bool isBusy() const;
+
+signals:
+    /** Emitted each time a file has been read
+      * @param done is the number of files read in the current batch
+      * @param total is the number of files queued in the current batch
+      */
+    void progress(int done, int total);
+
+    /** Emitted when the last file in a batch has been read or the batch was cancelled */
+    void finished();
+
+private:
+    /** Start a task that reads a file (or its proxy) and passes it to a callback on the GUI thread */
+    void queue(const QString& fileName, Callback onLoaded, bool proxy);
+
+    QThreadPool                                 pool;               /**< Worker threads, one per core */
+    std::shared_ptr<std::atomic<bool>>          cancelled;          /**< Cancel flag shared with the tasks of the current batch */
+    QHash<quint64, Callback>                    callbacks;          /**< Callbacks of queued files, only touched on the GUI thread */
+    quint64                                     nextTicket = 0;     /**< Identifies each queued file */
+    int                                         done = 0;           /**< Files finished in the current batch */
+    int                                         total = 0;          /**< Files queued in the current batch */
+};
+
+#endif
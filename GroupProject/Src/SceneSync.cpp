@@ -0,0 +1,204 @@
+/**     @file SceneSync.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps the renderer in step with the model tree by applying only the
+  *     changes to parts that have been marked as changed, instead of
+  *     rebuilding the whole scene each time.
+  */
+
+#include "SceneSync.h"
+#include "ModelPart.h"
+
+#include <vtkGlyph3DMapper.h>
+#include <vtkPointData.h>
+#include <vtkProperty.h>
+
+SceneSync::SceneSync(vtkRenderer* renderer)
+    : renderer(renderer) {
+}
+
+void SceneSync::partChanged(ModelPart* part) {
+    dirty.insert(part);
+}
+
+void SceneSync::subtreeChanged(ModelPart* part) {
+    dirty.insert(part);
+    for (int i = 0; i < part->childCount(); i++)
+        subtreeChanged(part->child(i));
+}
+
+void SceneSync::clear() {
+    for (auto it = placements.constBegin(); it != placements.constEnd(); ++it) {
+        if (it.value().added)
+            renderer->RemoveActor(it.key()->getActor());
+    }
+    for (const Group& group : groups) {
+        if (group.actor != nullptr)
+            renderer->RemoveActor(group.actor);
+    }
+
+    dirty.clear();
+    placements.clear();
+    groups.clear();
+}
+
+bool SceneSync::sync() {
+    if (dirty.isEmpty())
+        return false;
+
+    /* Take the set first, nothing below marks parts but it keeps the loop safe */
+    QSet<ModelPart*> changed;
+    changed.swap(dirty);
+    for (ModelPart* part : changed)
+        apply(part);
+    return true;
+}
+
+/**
+ * @brief Brings the way a part is drawn up to date.
+ *
+ * Costs a walk up to the root for the visibility, so grows with the
+ * part's depth in the tree, then a few property updates and at most one
+ * group change.
+ *
+ * @param part The changed part.
+ */
+void SceneSync::apply(ModelPart* part) {
+    // The root item only holds the tree together
+    if (part->parentItem() == nullptr)
+        return;
+
+    Placement& placement = placements[part];
+    vtkActor* actor = part->getActor();
+    if (!placement.added) {
+        renderer->AddActor(actor);
+        placement.added = true;
+    }
+
+    QColor colour = part->getColor();
+    actor->GetProperty()->SetColor(colour.redF(), colour.greenF(), colour.blueF());
+
+    /* Visible unfiltered parts are grouped by geometry so copies can be drawn together */
+    bool shown = part->isShown();
+    vtkPolyData* geometry = shown ? part->getInstanceGeometry() : nullptr;
+    GroupKey key(geometry, part->getSectionPlane());
+
+    if (placement.grouped && (geometry == nullptr || placement.key != key))
+        leave(placement);
+    if (geometry != nullptr) {
+        if (placement.grouped)
+            updateInstance(groups[key], placement.index);
+        else
+            join(part, key, placement);
+    }
+
+    bool drawnByGroup = placement.grouped && groups[placement.key].actor != nullptr;
+    actor->SetVisibility(shown && !drawnByGroup);
+}
+
+void SceneSync::join(ModelPart* part, const GroupKey& key, Placement& placement) {
+    Group& group = groups[key];
+    if (group.parts.isEmpty()) {
+        group.source = key.first;
+        group.plane = key.second;
+        group.positions = vtkSmartPointer<vtkPoints>::New();
+        group.colours = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        group.colours->SetName("Colours");
+        group.colours->SetNumberOfComponents(4);
+        group.instances = vtkSmartPointer<vtkPolyData>::New();
+        group.instances->SetPoints(group.positions);
+        group.instances->GetPointData()->AddArray(group.colours);
+    }
+
+    placement.grouped = true;
+    placement.key = key;
+    placement.index = group.parts.size();
+
+    unsigned char rgba[4] = { 0, 0, 0, 255 };
+    group.parts.append(part);
+    group.positions->InsertNextPoint(0.0, 0.0, 0.0);
+    group.colours->InsertNextTypedTuple(rgba);
+    updateInstance(group, placement.index);
+    updateGroupActor(group);
+}
+
+void SceneSync::leave(Placement& placement) {
+    Group& group = groups[placement.key];
+    int index = placement.index;
+    int last = group.parts.size() - 1;
+
+    /* Fill the gap with the last member so no other member has to move */
+    if (index != last) {
+        ModelPart* moved = group.parts[last];
+        group.parts[index] = moved;
+        placements[moved].index = index;
+        group.positions->SetPoint(index, group.positions->GetPoint(last));
+        unsigned char rgba[4];
+        group.colours->GetTypedTuple(last, rgba);
+        group.colours->SetTypedTuple(index, rgba);
+    }
+    group.parts.removeLast();
+    group.positions->SetNumberOfPoints(last);
+    group.colours->SetNumberOfTuples(last);
+    group.positions->Modified();
+    group.colours->Modified();
+    group.instances->Modified();
+
+    GroupKey key = placement.key;
+    placement.grouped = false;
+    placement.index = -1;
+
+    if (group.parts.isEmpty()) {
+        if (group.actor != nullptr)
+            renderer->RemoveActor(group.actor);
+        groups.remove(key);
+    } else {
+        updateGroupActor(group);
+    }
+}
+
+void SceneSync::updateInstance(Group& group, int index) {
+    ModelPart* part = group.parts[index];
+    QVector3D position = part->getPosition();
+    QColor colour = part->getColor();
+    unsigned char rgba[4] = { (unsigned char)colour.red(), (unsigned char)colour.green(),
+                              (unsigned char)colour.blue(), 255 };
+
+    group.positions->SetPoint(index, position.x(), position.y(), position.z());
+    group.colours->SetTypedTuple(index, rgba);
+    group.positions->Modified();
+    group.colours->Modified();
+    group.instances->Modified();
+}
+
+void SceneSync::updateGroupActor(Group& group) {
+    bool useGlyphs = group.parts.size() > 1;
+
+    if (useGlyphs && group.actor == nullptr) {
+        vtkSmartPointer<vtkGlyph3DMapper> mapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+        mapper->SetInputData(group.instances);
+        mapper->SetSourceData(group.source);
+        mapper->ScalingOff();
+        mapper->OrientOff();
+        mapper->SetScalarModeToUsePointFieldData();
+        mapper->SelectColorArray("Colours");
+        mapper->SetColorModeToDirectScalars();
+        if (group.plane != nullptr)
+            mapper->AddClippingPlane(group.plane);
+
+        group.actor = vtkSmartPointer<vtkActor>::New();
+        group.actor->SetMapper(mapper);
+        renderer->AddActor(group.actor);
+
+        /* Only the member that was drawn alone until now has its actor showing */
+        for (ModelPart* part : group.parts)
+            part->getActor()->SetVisibility(false);
+    } else if (!useGlyphs && group.actor != nullptr) {
+        renderer->RemoveActor(group.actor);
+        group.actor = nullptr;
+
+        /* Group members are always visible, the last one draws itself again */
+        group.parts.first()->getActor()->SetVisibility(true);
+    }
+}
@@ -0,0 +1,105 @@
+/**     @file SceneSync.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps the renderer in step with the model tree by applying only the
+  *     changes to parts that have been marked as changed, instead of
+  *     rebuilding the whole scene each time.
+  */
+
+#ifndef VIEWER_SCENESYNC_H
+#define VIEWER_SCENESYNC_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPlane.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkUnsignedCharArray.h>
+
+class ModelPart;
+
+/* Each part's own actor is added to the renderer once and then only has its
+ * visibility and colour changed. Visible parts with unfiltered geometry are
+ * also grouped by geometry: a group of two or more is drawn by one glyph
+ * mapper, which places an instance of the geometry at each part's position
+ * in its colour, and the members' own actors are hidden. Parts join and
+ * leave groups in constant time, so a change to one part costs the same
+ * however large the assembly is. Only used on the GUI thread. */
+class SceneSync {
+public:
+    /** Constructor
+      * @param renderer is the renderer the parts are shown in
+      */
+    SceneSync(vtkRenderer* renderer);
+
+    /** Mark a part as changed, e.g. its colour, geometry, filters or position
+      * @param part is the part
+      */
+    void partChanged(ModelPart* part);
+
+    /** Mark a part and every part below it as changed, e.g. after the
+      * visibility of a group changes or a branch is added to the tree
+      * @param part is the root of the branch
+      */
+    void subtreeChanged(ModelPart* part);
+
+    /** Remove every part from the renderer and forget them, called before
+      * the parts are deleted */
+    void clear();
+
+    /** Apply the changes marked since the last call
+      * @return true if anything was changed
+      */
+    bool sync();
+
+private:
+    typedef QPair<vtkPolyData*, vtkPlane*> GroupKey;
+
+    /* Parts sharing geometry and section plane, in glyph point order */
+    struct Group {
+        vtkSmartPointer<vtkPolyData>            source;     /**< Shared geometry, kept alive while the group exists */
+        vtkSmartPointer<vtkPlane>               plane;      /**< Section plane, nullptr for none */
+        QList<ModelPart*>                       parts;
+        vtkSmartPointer<vtkPoints>              positions;  /**< Position of each part */
+        vtkSmartPointer<vtkUnsignedCharArray>   colours;    /**< RGBA colour of each part */
+        vtkSmartPointer<vtkPolyData>            instances;  /**< Positions and colours, the glyph mapper input */
+        vtkSmartPointer<vtkActor>               actor;      /**< Glyph actor, nullptr while the group has one part */
+    };
+
+    /* How a part is currently drawn */
+    struct Placement {
+        bool        added = false;      /**< Own actor has been added to the renderer */
+        bool        grouped = false;    /**< Part is a member of a group */
+        GroupKey    key;                /**< Group the part is in */
+        int         index = -1;         /**< Position of the part in its group */
+    };
+
+    /** Bring the way a part is drawn up to date */
+    void apply(ModelPart* part);
+
+    /** Add a part to the end of a group */
+    void join(ModelPart* part, const GroupKey& key, Placement& placement);
+
+    /** Take a part out of its group, moving the last member into its place */
+    void leave(Placement& placement);
+
+    /** Copy a member's position and colour into the group's glyph input */
+    void updateInstance(Group& group, int index);
+
+    /** Draw a group with a glyph actor or with its single member's own
+      * actor, depending on its size */
+    void updateGroupActor(Group& group);
+
+    vtkRenderer*                    renderer;
+    QSet<ModelPart*>                dirty;          /**< Parts changed since the last sync() */
+    QHash<ModelPart*, Placement>    placements;
+    QHash<GroupKey, Group>          groups;
+};
+
+#endif
@@ -0,0 +1,41 @@
+/**     @file SharedGeometry.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Lets the desktop and VR threads draw the same point and cell buffers
+  *     instead of each keeping a copy of every part's geometry.
+  */
+
+#include "SharedGeometry.h"
+
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+
+/* Compute the cached ranges of every array in a set of attributes */
+static void computeRanges(vtkFieldData* attributes) {
+    for (int i = 0; i < attributes->GetNumberOfArrays(); i++) {
+        vtkDataArray* array = attributes->GetArray(i);
+        if (array == nullptr)
+            continue;
+        for (int c = -1; c < array->GetNumberOfComponents(); c++)
+            array->GetRange(c);
+    }
+}
+
+vtkSmartPointer<vtkPolyData> SharedGeometry::share(vtkPolyData* data) {
+    if (data == nullptr)
+        return nullptr;
+
+    /* The points' bounds are cached in the shared vtkPoints, the polydata's
+     * own bounds are cached per polydata */
+    if (data->GetPoints() != nullptr)
+        data->GetPoints()->GetBounds();
+    computeRanges(data->GetPointData());
+    computeRanges(data->GetCellData());
+
+    vtkSmartPointer<vtkPolyData> shared = vtkSmartPointer<vtkPolyData>::New();
+    shared->ShallowCopy(data);
+    shared->ComputeBounds();
+    return shared;
+}
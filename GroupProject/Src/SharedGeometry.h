@@ -0,0 +1,36 @@
+/**     @file SharedGeometry.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Lets the desktop and VR threads draw the same point and cell buffers
+  *     instead of each keeping a copy of every part's geometry.
+  */
+
+#ifndef VIEWER_SHAREDGEOMETRY_H
+#define VIEWER_SHAREDGEOMETRY_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/* Part geometry is never changed in place once it is shown: loading,
+ * filtering and decimating all make new polydata. So a second polydata
+ * object referring to the same arrays can be handed to another thread and
+ * both can draw from them, each with its own polydata and mapper state.
+ * Shared geometry is immutable: nothing may change it, a new result is
+ * always new polydata. The arrays are freed once the last polydata
+ * referring to them has gone. */
+class SharedGeometry {
+public:
+    /** Make a polydata that shares a surface's arrays, for another thread.
+      * Values VTK would otherwise work out and store in the shared arrays
+      * the first time they are asked for, such as bounds and ranges, are
+      * worked out here first so neither thread writes to the arrays later.
+      * Costs nothing that grows with the size of the surface once those
+      * values are known.
+      * @param data is the surface, it must not be changed in place afterwards
+      * @return a polydata sharing data's points, cells and attributes
+      */
+    static vtkSmartPointer<vtkPolyData> share(vtkPolyData* data);
+};
+
+#endif
@@ -0,0 +1,429 @@
+/**     @file SurfaceClipper.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Clips triangle surfaces with a plane directly as polydata, without
+  *     going through an unstructured grid, and optionally caps the cut.
+  */
+
+#include "SurfaceClipper.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkClipPolyData.h>
+#include <vtkContourTriangulator.h>
+#include <vtkDataArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+/* Number of triangles in each block of work */
+static const vtkIdType grainSize = 65536;
+
+/* Output needed by one block of triangles, then where its output starts */
+struct BlockCount {
+    vtkIdType triangles = 0;
+    vtkIdType newPoints = 0;
+};
+
+/* A piece of the cut, between the cut points on two edges. The edges are
+ * identified by their end points so cut points shared by two triangles can
+ * be matched up when building the cap. */
+struct CutSegment {
+    vtkTypeInt64    edge[2];
+    vtkTypeInt32    point[2];
+};
+
+/* Where a cut point came from, so point and cell data can follow it: the
+ * two ends of the edge it is on, how far along it is, and the triangle that
+ * made it */
+struct CutSource {
+    vtkIdType   from[2];
+    double      s;
+    vtkIdType   triangle;
+};
+
+/* Identify an edge regardless of the direction it is walked in */
+static vtkTypeInt64 edgeKey(vtkIdType a, vtkIdType b) {
+    return a < b ? (vtkTypeInt64(a) << 32) | b : (vtkTypeInt64(b) << 32) | a;
+}
+
+/* Clipping of the triangles held in one type of connectivity array */
+template <typename T>
+class TriangleClipper {
+public:
+    TriangleClipper(const T* conn, vtkIdType triangles, vtkPoints* points, const std::vector<double>& dist,
+                    const std::vector<vtkTypeInt32>& keptId, vtkIdType keptPoints)
+        : conn(conn), triangles(triangles), points(points), dist(dist), keptId(keptId), keptPoints(keptPoints) {}
+
+    /* Count the triangles and cut points each block will produce */
+    void count(std::vector<BlockCount>& blocks) const {
+        vtkSMPTools::For(0, vtkIdType(blocks.size()), 1, [&](vtkIdType first, vtkIdType last) {
+            for (vtkIdType b = first; b < last; b++) {
+                BlockCount c;
+                for (vtkIdType t = b * grainSize; t < std::min(triangles, (b + 1) * grainSize); t++) {
+                    int kept = (dist[conn[3 * t]] >= 0.0) + (dist[conn[3 * t + 1]] >= 0.0) + (dist[conn[3 * t + 2]] >= 0.0);
+                    c.triangles += (kept == 3 || kept == 1) ? 1 : (kept == 2 ? 2 : 0);
+                    c.newPoints += (kept == 1 || kept == 2) ? 2 : 0;
+                }
+                blocks[b] = c;
+            }
+        });
+    }
+
+    /* Write each block's triangles and cut points, starting where the block's
+     * output starts. cutSources and cellSources are only filled if given. */
+    void fill(const std::vector<BlockCount>& starts, vtkPoints* outPoints, vtkTypeInt32* outConn,
+              std::vector<CutSegment>* segments, CutSource* cutSources, vtkIdType* cellSources) const {
+        vtkSMPTools::For(0, vtkIdType(starts.size()) - 1, 1, [&](vtkIdType first, vtkIdType last) {
+            for (vtkIdType b = first; b < last; b++) {
+                vtkTypeInt32* out = outConn + 3 * starts[b].triangles;
+                vtkIdType next = keptPoints + starts[b].newPoints;
+                CutSegment* segment = segments ? segments->data() + starts[b].newPoints / 2 : nullptr;
+
+                for (vtkIdType t = b * grainSize; t < std::min(triangles, (b + 1) * grainSize); t++) {
+                    vtkIdType v[3] = { vtkIdType(conn[3 * t]), vtkIdType(conn[3 * t + 1]), vtkIdType(conn[3 * t + 2]) };
+                    bool in[3] = { dist[v[0]] >= 0.0, dist[v[1]] >= 0.0, dist[v[2]] >= 0.0 };
+                    int kept = in[0] + in[1] + in[2];
+
+                    if (kept == 0)
+                        continue;
+                    if (cellSources) {
+                        vtkIdType* source = cellSources + (out - outConn) / 3;
+                        source[0] = t;
+                        if (kept == 2)
+                            source[1] = t;
+                    }
+                    if (kept == 3) {
+                        *out++ = keptId[v[0]];
+                        *out++ = keptId[v[1]];
+                        *out++ = keptId[v[2]];
+                        continue;
+                    }
+
+                    /* Rotate so that a is the odd one out: the only kept vertex,
+                     * or the only removed one. Orientation is unchanged. */
+                    int r = 0;
+                    while (in[r] == (kept == 1 ? false : true))
+                        r++;
+                    vtkIdType a = v[r], bb = v[(r + 1) % 3], c = v[(r + 2) % 3];
+
+                    vtkTypeInt32 ab = vtkTypeInt32(next++);
+                    vtkTypeInt32 ca = vtkTypeInt32(next++);
+                    cutPoint(a, bb, outPoints, ab, cutSources, t);
+                    cutPoint(c, a, outPoints, ca, cutSources, t);
+
+                    if (kept == 1) {
+                        /* a is kept: one triangle a, ab, ca */
+                        *out++ = keptId[a];
+                        *out++ = ab;
+                        *out++ = ca;
+                        if (segment)
+                            *segment++ = { { edgeKey(a, bb), edgeKey(c, a) }, { ab, ca } };
+                    } else {
+                        /* a is removed: the quad bb, c, ca, ab as two triangles */
+                        *out++ = keptId[bb];
+                        *out++ = keptId[c];
+                        *out++ = ca;
+                        *out++ = keptId[bb];
+                        *out++ = ca;
+                        *out++ = ab;
+                        if (segment)
+                            *segment++ = { { edgeKey(c, a), edgeKey(a, bb) }, { ca, ab } };
+                    }
+                }
+            }
+        });
+    }
+
+private:
+    /* Where an edge crosses the plane. Always interpolated from the lower
+     * point id, so both triangles on the edge get exactly the same point. */
+    void cutPoint(vtkIdType p, vtkIdType q, vtkPoints* outPoints, vtkIdType id, CutSource* cutSources, vtkIdType t) const {
+        if (p > q)
+            std::swap(p, q);
+        double pp[3], pq[3], x[3];
+        points->GetPoint(p, pp);
+        points->GetPoint(q, pq);
+        double s = dist[p] / (dist[p] - dist[q]);
+        for (int i = 0; i < 3; i++)
+            x[i] = pp[i] + s * (pq[i] - pp[i]);
+        outPoints->SetPoint(id, x);
+        if (cutSources)
+            cutSources[id - keptPoints] = { { p, q }, s, t };
+    }
+
+    const T*                            conn;
+    vtkIdType                           triangles;
+    vtkPoints*                          points;
+    const std::vector<double>&          dist;
+    const std::vector<vtkTypeInt32>&    keptId;
+    vtkIdType                           keptPoints;
+};
+
+/* Close the cut with triangles. Cut points on the same edge are merged so
+ * the segments join up into loops, which are then triangulated in the plane. */
+static void addCap(vtkPoints* outPoints, const std::vector<CutSegment>& segments, const double normal[3],
+                   std::vector<vtkTypeInt32>& capConn) {
+    if (segments.empty())
+        return;
+
+    std::unordered_map<vtkTypeInt64, vtkIdType> pointOfEdge;
+    pointOfEdge.reserve(segments.size());
+
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    lines->AllocateExact(vtkIdType(segments.size()), 2 * vtkIdType(segments.size()));
+    for (const CutSegment& s : segments) {
+        vtkIdType line[2];
+        for (int i = 0; i < 2; i++)
+            line[i] = pointOfEdge.emplace(s.edge[i], s.point[i]).first->second;
+        if (line[0] != line[1])
+            lines->InsertNextCell(2, line);
+    }
+
+    vtkSmartPointer<vtkPolyData> contours = vtkSmartPointer<vtkPolyData>::New();
+    contours->SetPoints(outPoints);
+    contours->SetLines(lines);
+
+    /* The cap faces away from the part, towards the side that was cut away */
+    double capNormal[3] = { -normal[0], -normal[1], -normal[2] };
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    vtkContourTriangulator::TriangulateContours(contours, 0, lines->GetNumberOfCells(), polys, capNormal);
+
+    vtkIdType npts;
+    const vtkIdType* pts;
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts); ) {
+        for (vtkIdType i = 1; i + 1 < npts; i++) {
+            capConn.push_back(vtkTypeInt32(pts[0]));
+            capConn.push_back(vtkTypeInt32(pts[i]));
+            capConn.push_back(vtkTypeInt32(pts[i + 1]));
+        }
+    }
+}
+
+/* Give the cap triangles points of their own, so the normals interpolated
+ * for the sides do not shade the cap. The cap starts at capStart in the
+ * connectivity and only uses cut points, which are numbered from keptPoints.
+ * Returns the cut point each new point copies, in order. */
+static std::vector<vtkIdType> separateCap(vtkPoints* outPoints, std::vector<vtkTypeInt32>& outConn, size_t capStart,
+                                          vtkIdType keptPoints, vtkIdType cutPoints) {
+    std::vector<vtkTypeInt32> capId(cutPoints, -1);
+    std::vector<vtkIdType> copied;
+    for (size_t i = capStart; i < outConn.size(); i++) {
+        vtkTypeInt32& id = capId[outConn[i] - keptPoints];
+        if (id < 0) {
+            double p[3];
+            outPoints->GetPoint(outConn[i], p);
+            id = vtkTypeInt32(outPoints->InsertNextPoint(p));
+            copied.push_back(outConn[i]);
+        }
+        outConn[i] = id;
+    }
+    return copied;
+}
+
+/* Carry point and cell data over to the clipped surface. Kept points copy
+ * theirs and cut points interpolate along their edge, the same way their
+ * position was. Triangles copy the data of the triangle they were cut from,
+ * cap triangles that of the triangle which made their first point. Cap
+ * points have the cap's normal in place of an interpolated one. */
+static void copyData(vtkPolyData* input, vtkPolyData* output, const std::vector<vtkTypeInt32>& keptId, vtkIdType keptPoints,
+                     const std::vector<CutSource>& cutSources, const std::vector<vtkIdType>& capCopies,
+                     const std::vector<vtkIdType>& cellSources, const double capNormal[3]) {
+    vtkPointData* inPD = input->GetPointData();
+    if (inPD->GetNumberOfArrays() > 0) {
+        vtkPointData* outPD = output->GetPointData();
+        outPD->InterpolateAllocate(inPD, output->GetNumberOfPoints());
+
+        vtkSmartPointer<vtkIdList> fromIds = vtkSmartPointer<vtkIdList>::New();
+        vtkSmartPointer<vtkIdList> toIds = vtkSmartPointer<vtkIdList>::New();
+        fromIds->Allocate(keptPoints);
+        toIds->Allocate(keptPoints);
+        for (vtkIdType i = 0; i < vtkIdType(keptId.size()); i++) {
+            if (keptId[i] >= 0) {
+                fromIds->InsertNextId(i);
+                toIds->InsertNextId(keptId[i]);
+            }
+        }
+        outPD->CopyData(inPD, fromIds, toIds);
+
+        for (vtkIdType i = 0; i < vtkIdType(cutSources.size()); i++) {
+            const CutSource& c = cutSources[i];
+            outPD->InterpolateEdge(inPD, keptPoints + i, c.from[0], c.from[1], c.s);
+        }
+        vtkIdType capPoint = keptPoints + vtkIdType(cutSources.size());
+        for (vtkIdType copied : capCopies) {
+            const CutSource& c = cutSources[copied - keptPoints];
+            outPD->InterpolateEdge(inPD, capPoint++, c.from[0], c.from[1], c.s);
+        }
+
+        vtkDataArray* normals = outPD->GetNormals();
+        if (normals != nullptr && normals->GetNumberOfComponents() == 3) {
+            double n[3] = { capNormal[0], capNormal[1], capNormal[2] };
+            vtkMath::Normalize(n);
+            for (vtkIdType i = capPoint - vtkIdType(capCopies.size()); i < capPoint; i++)
+                normals->SetTuple(i, n);
+        }
+    }
+
+    vtkCellData* inCD = input->GetCellData();
+    if (inCD->GetNumberOfArrays() > 0) {
+        vtkSmartPointer<vtkIdList> fromIds = vtkSmartPointer<vtkIdList>::New();
+        vtkSmartPointer<vtkIdList> toIds = vtkSmartPointer<vtkIdList>::New();
+        fromIds->SetNumberOfIds(vtkIdType(cellSources.size()));
+        toIds->SetNumberOfIds(vtkIdType(cellSources.size()));
+        for (vtkIdType t = 0; t < vtkIdType(cellSources.size()); t++) {
+            fromIds->SetId(t, cellSources[t]);
+            toIds->SetId(t, t);
+        }
+        vtkCellData* outCD = output->GetCellData();
+        outCD->CopyAllocate(inCD, vtkIdType(cellSources.size()));
+        outCD->CopyData(inCD, fromIds, toIds);
+    }
+}
+
+/* Clip anything other than plain triangles with VTK's own polydata clipper */
+static vtkSmartPointer<vtkPolyData> clipGeneral(vtkPolyData* input, const double origin[3], const double normal[3]) {
+    vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(origin[0], origin[1], origin[2]);
+    plane->SetNormal(normal[0], normal[1], normal[2]);
+
+    vtkSmartPointer<vtkClipPolyData> clipFilter = vtkSmartPointer<vtkClipPolyData>::New();
+    clipFilter->SetInputData(input);
+    clipFilter->SetClipFunction(plane);
+    clipFilter->Update();
+
+    vtkSmartPointer<vtkPolyData> output = clipFilter->GetOutput();
+    return output;
+}
+
+template <typename T>
+static vtkSmartPointer<vtkPolyData> clipTriangles(vtkPolyData* input, const T* conn, const double origin[3], const double normal[3], bool cap) {
+    vtkPoints* points = input->GetPoints();
+    vtkIdType n = points->GetNumberOfPoints();
+    vtkIdType triangles = input->GetPolys()->GetNumberOfCells();
+
+    /* 1. Signed distance of each point from the plane */
+    std::vector<double> dist(n);
+    vtkSMPTools::For(0, n, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        double p[3];
+        for (vtkIdType i = begin; i < end; i++) {
+            points->GetPoint(i, p);
+            dist[i] = (p[0] - origin[0]) * normal[0] + (p[1] - origin[1]) * normal[1] + (p[2] - origin[2]) * normal[2];
+        }
+    });
+
+    /* 2. Number the points that are kept, in input order */
+    std::vector<vtkTypeInt32> keptId(n, -1);
+    vtkIdType keptPoints = 0;
+    for (vtkIdType i = 0; i < n; i++) {
+        if (dist[i] >= 0.0)
+            keptId[i] = vtkTypeInt32(keptPoints++);
+    }
+    if (keptPoints == n)
+        return input;
+
+    /* 3. Count the output of each block of triangles, then work out where each block's output starts */
+    TriangleClipper<T> clipper(conn, triangles, points, dist, keptId, keptPoints);
+    vtkIdType blockCount = (triangles + grainSize - 1) / grainSize;
+    std::vector<BlockCount> starts(blockCount + 1);
+    clipper.count(starts);
+    BlockCount total;
+    for (BlockCount& block : starts) {
+        BlockCount size = block;
+        block = total;
+        total.triangles += size.triangles;
+        total.newPoints += size.newPoints;
+    }
+
+    /* Cap points may be copied once more to keep their own normals */
+    bool hasPointData = input->GetPointData()->GetNumberOfArrays() > 0;
+    bool hasCellData = input->GetCellData()->GetNumberOfArrays() > 0;
+    vtkIdType outPointCount = keptPoints + total.newPoints;
+    if (outPointCount + (cap && hasPointData ? total.newPoints : 0) > VTK_TYPE_INT32_MAX || 3 * total.triangles > VTK_TYPE_INT32_MAX)
+        return clipGeneral(input, origin, normal);
+
+    /* 4. Copy the kept points, then write the clipped triangles and the cut points */
+    vtkSmartPointer<vtkPoints> outPoints = vtkSmartPointer<vtkPoints>::New();
+    outPoints->SetDataType(points->GetDataType());
+    outPoints->SetNumberOfPoints(outPointCount);
+    vtkSMPTools::For(0, n, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        double p[3];
+        for (vtkIdType i = begin; i < end; i++) {
+            if (keptId[i] >= 0) {
+                points->GetPoint(i, p);
+                outPoints->SetPoint(keptId[i], p);
+            }
+        }
+    });
+
+    std::vector<vtkTypeInt32> outConn(3 * total.triangles);
+    std::vector<CutSegment> segments(cap ? total.newPoints / 2 : 0);
+    std::vector<CutSource> cutSources(hasPointData || (cap && hasCellData) ? total.newPoints : 0);
+    std::vector<vtkIdType> cellSources(hasCellData ? total.triangles : 0);
+    clipper.fill(starts, outPoints, outConn.data(), cap ? &segments : nullptr,
+                 cutSources.empty() ? nullptr : cutSources.data(), hasCellData ? cellSources.data() : nullptr);
+
+    /* 5. Close the cut */
+    std::vector<vtkIdType> capCopies;
+    if (cap) {
+        size_t capStart = outConn.size();
+        addCap(outPoints, segments, normal, outConn);
+        if (hasCellData) {
+            for (size_t i = capStart; i < outConn.size(); i += 3)
+                cellSources.push_back(cutSources[outConn[i] - keptPoints].triangle);
+        }
+        if (hasPointData)
+            capCopies = separateCap(outPoints, outConn, capStart, keptPoints, total.newPoints);
+    }
+
+    vtkIdType outTriangles = vtkIdType(outConn.size()) / 3;
+    vtkSmartPointer<vtkTypeInt32Array> connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(3 * outTriangles);
+    std::copy(outConn.begin(), outConn.end(), connectivity->GetPointer(0));
+
+    vtkSmartPointer<vtkTypeInt32Array> offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(outTriangles + 1);
+    vtkTypeInt32* offset = offsets->GetPointer(0);
+    vtkSMPTools::For(0, outTriangles + 1, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++)
+            offset[t] = vtkTypeInt32(3 * t);
+    });
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(outPoints);
+    output->SetPolys(cells);
+
+    /* 6. Carry the point and cell data over */
+    double capNormal[3] = { -normal[0], -normal[1], -normal[2] };
+    copyData(input, output, keptId, keptPoints, cutSources, capCopies, cellSources, capNormal);
+    return output;
+}
+
+vtkSmartPointer<vtkPolyData> SurfaceClipper::clip(vtkPolyData* input, const double origin[3], const double normal[3], bool cap) {
+    vtkPoints* points = input->GetPoints();
+    vtkCellArray* polys = input->GetPolys();
+    if (points == nullptr || polys == nullptr || polys->GetNumberOfCells() == 0 || polys->IsHomogeneous() != 3
+        || input->GetNumberOfVerts() || input->GetNumberOfLines() || input->GetNumberOfStrips()
+        || points->GetNumberOfPoints() > VTK_TYPE_INT32_MAX)
+        return clipGeneral(input, origin, normal);
+
+    vtkDataArray* conn = polys->GetConnectivityArray();
+    if (vtkTypeInt32Array* conn32 = vtkTypeInt32Array::SafeDownCast(conn))
+        return clipTriangles(input, conn32->GetPointer(0), origin, normal, cap);
+    if (vtkTypeInt64Array* conn64 = vtkTypeInt64Array::SafeDownCast(conn))
+        return clipTriangles(input, conn64->GetPointer(0), origin, normal, cap);
+    return clipGeneral(input, origin, normal);
+}
@@ -0,0 +1,35 @@
+/**     @file SurfaceClipper.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Clips triangle surfaces with a plane directly as polydata, without
+  *     going through an unstructured grid, and optionally caps the cut.
+  */
+
+#ifndef VIEWER_SURFACECLIPPER_H
+#define VIEWER_SURFACECLIPPER_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class SurfaceClipper {
+public:
+    /** Cut away the part of a surface on the negative side of a plane.
+      * Triangles are clipped in parallel. Triangles crossing the plane are
+      * split, keeping their orientation, and the points on the cut are
+      * computed the same way for both triangles sharing an edge so the cut
+      * has no cracks. Anything other than triangles is clipped with
+      * vtkClipPolyData instead, without a cap. Point data is interpolated at
+      * the cut points and cell data copied from the triangle each piece came
+      * from, so normals computed before clipping survive it. The cap gets
+      * points of its own with the plane's normal.
+      * @param input is the surface to clip
+      * @param origin is a point on the plane
+      * @param normal points towards the side that is kept
+      * @param cap is true to close the cut with triangles in the plane
+      * @return the clipped surface, input itself if nothing is cut away
+      */
+    static vtkSmartPointer<vtkPolyData> clip(vtkPolyData* input, const double origin[3], const double normal[3], bool cap);
+};
+
+#endif
@@ -0,0 +1,169 @@
+/**     @file SurfaceShrinker.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Shrinks the cells of a surface towards their centres directly as
+  *     polydata, without going through an unstructured grid and extracting
+  *     the surface again afterwards.
+  */
+
+#include "SurfaceShrinker.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdList.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkShrinkFilter.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+
+/* Number of cells in each block of work */
+static const vtkIdType grainSize = 65536;
+
+/* Shrink cells that all have K points. Cell c's points become output points
+ * K*c to K*c + K-1. With K fixed the loops over a cell's points unroll, so
+ * each point is a short run of independent multiply-adds the compiler can
+ * vectorise, and the output is written as one contiguous stream. */
+template <int K, typename P, typename T>
+static void shrinkCells(const P* in, const T* conn, vtkIdType cells, double factor, P* out) {
+    const P keep = P(factor);
+    const P pull = P((1.0 - factor) / K);
+
+    vtkSMPTools::For(0, cells, grainSize, [=](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType c = begin; c < end; c++) {
+            const T* ids = conn + K * c;
+
+            /* Gather the cell's points, they can be anywhere in the input */
+            P x[3 * K];
+            for (int j = 0; j < K; j++) {
+                const P* p = in + 3 * vtkIdType(ids[j]);
+                for (int i = 0; i < 3; i++)
+                    x[3 * j + i] = p[i];
+            }
+
+            P centre[3] = { 0, 0, 0 };
+            for (int j = 0; j < K; j++) {
+                for (int i = 0; i < 3; i++)
+                    centre[i] += x[3 * j + i];
+            }
+
+            /* c + f (p - c) = f p + (1 - f) c */
+            P* o = out + 3 * K * c;
+            for (int j = 0; j < K; j++) {
+                for (int i = 0; i < 3; i++)
+                    o[3 * j + i] = keep * x[3 * j + i] + pull * centre[i];
+            }
+        }
+    });
+}
+
+/* Shrink anything other than plain triangles or quads the way VTK does */
+static vtkSmartPointer<vtkPolyData> shrinkGeneral(vtkPolyData* input, double factor) {
+    vtkSmartPointer<vtkShrinkFilter> shrinkFilter = vtkSmartPointer<vtkShrinkFilter>::New();
+    shrinkFilter->SetInputData(input);
+    shrinkFilter->SetShrinkFactor(factor);
+
+    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
+    geometryFilter->SetInputConnection(shrinkFilter->GetOutputPort());
+    geometryFilter->Update();
+
+    vtkSmartPointer<vtkPolyData> output = geometryFilter->GetOutput();
+    return output;
+}
+
+template <typename P, typename T>
+static vtkSmartPointer<vtkPolyData> shrinkPolys(vtkPolyData* input, const P* in, const T* conn, int k, double factor) {
+    vtkIdType cells = input->GetPolys()->GetNumberOfCells();
+    vtkIdType outCount = k * cells;
+
+    vtkSmartPointer<vtkPoints> outPoints = vtkSmartPointer<vtkPoints>::New();
+    outPoints->SetDataType(input->GetPoints()->GetDataType());
+    outPoints->SetNumberOfPoints(outCount);
+    P* out = static_cast<P*>(outPoints->GetVoidPointer(0));
+
+    if (k == 3)
+        shrinkCells<3>(in, conn, cells, factor, out);
+    else
+        shrinkCells<4>(in, conn, cells, factor, out);
+
+    /* Every cell has its own points, in order, so the connectivity just counts up */
+    vtkSmartPointer<vtkTypeInt32Array> connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(outCount);
+    vtkTypeInt32* outConn = connectivity->GetPointer(0);
+    vtkSmartPointer<vtkTypeInt32Array> offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(cells + 1);
+    vtkTypeInt32* offset = offsets->GetPointer(0);
+    vtkSMPTools::For(0, outCount, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; i++)
+            outConn[i] = vtkTypeInt32(i);
+    });
+    vtkSMPTools::For(0, cells + 1, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType c = begin; c < end; c++)
+            offset[c] = vtkTypeInt32(k * c);
+    });
+
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(outPoints);
+    output->SetPolys(polys);
+
+    /* Cells map one to one, each output point comes from one input point */
+    output->GetCellData()->PassData(input->GetCellData());
+    vtkPointData* inPD = input->GetPointData();
+    if (inPD->GetNumberOfArrays() > 0) {
+        vtkSmartPointer<vtkIdList> fromIds = vtkSmartPointer<vtkIdList>::New();
+        vtkSmartPointer<vtkIdList> toIds = vtkSmartPointer<vtkIdList>::New();
+        fromIds->SetNumberOfIds(outCount);
+        toIds->SetNumberOfIds(outCount);
+        vtkIdType* from = fromIds->GetPointer(0);
+        vtkIdType* to = toIds->GetPointer(0);
+        vtkSMPTools::For(0, outCount, grainSize, [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType i = begin; i < end; i++) {
+                from[i] = vtkIdType(conn[i]);
+                to[i] = i;
+            }
+        });
+
+        vtkPointData* outPD = output->GetPointData();
+        outPD->CopyAllocate(inPD, outCount);
+        outPD->CopyData(inPD, fromIds, toIds);
+    }
+    return output;
+}
+
+template <typename P>
+static vtkSmartPointer<vtkPolyData> shrinkPolys(vtkPolyData* input, const P* in, int k, double factor) {
+    vtkDataArray* conn = input->GetPolys()->GetConnectivityArray();
+    if (vtkTypeInt32Array* conn32 = vtkTypeInt32Array::SafeDownCast(conn))
+        return shrinkPolys(input, in, conn32->GetPointer(0), k, factor);
+    if (vtkTypeInt64Array* conn64 = vtkTypeInt64Array::SafeDownCast(conn))
+        return shrinkPolys(input, in, conn64->GetPointer(0), k, factor);
+    return shrinkGeneral(input, factor);
+}
+
+vtkSmartPointer<vtkPolyData> SurfaceShrinker::shrink(vtkPolyData* input, double factor) {
+    vtkPoints* points = input->GetPoints();
+    vtkCellArray* polys = input->GetPolys();
+    if (points == nullptr || polys == nullptr || polys->GetNumberOfCells() == 0
+        || input->GetNumberOfVerts() || input->GetNumberOfLines() || input->GetNumberOfStrips())
+        return shrinkGeneral(input, factor);
+
+    /* Output ids are stored in 32 bits, like the clipper's */
+    vtkIdType k = polys->IsHomogeneous();
+    if ((k != 3 && k != 4) || k * polys->GetNumberOfCells() > VTK_TYPE_INT32_MAX)
+        return shrinkGeneral(input, factor);
+
+    vtkDataArray* data = points->GetData();
+    if (vtkFloatArray* floats = vtkFloatArray::SafeDownCast(data))
+        return shrinkPolys(input, floats->GetPointer(0), int(k), factor);
+    if (vtkDoubleArray* doubles = vtkDoubleArray::SafeDownCast(data))
+        return shrinkPolys(input, doubles->GetPointer(0), int(k), factor);
+    return shrinkGeneral(input, factor);
+}
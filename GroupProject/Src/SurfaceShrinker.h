@@ -0,0 +1,30 @@
+/**     @file SurfaceShrinker.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Shrinks the cells of a surface towards their centres directly as
+  *     polydata, without going through an unstructured grid and extracting
+  *     the surface again afterwards.
+  */
+
+#ifndef VIEWER_SURFACESHRINKER_H
+#define VIEWER_SURFACESHRINKER_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class SurfaceShrinker {
+public:
+    /** Shrink each cell of a surface towards its own centre, giving every
+      * cell its own copy of its points. Surfaces made only of triangles or
+      * only of quads, with float or double points, are shrunk in parallel.
+      * Anything else goes through vtkShrinkFilter and vtkGeometryFilter
+      * instead. Point and cell data are carried over.
+      * @param input is the surface to shrink
+      * @param factor is 1 for the original size, 0 to collapse each cell to a point
+      * @return the shrunk surface
+      */
+    static vtkSmartPointer<vtkPolyData> shrink(vtkPolyData* input, double factor);
+};
+
+#endif
@@ -0,0 +1,55 @@
+/**     @file TriangleSoup.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Builds polydata from a flat list of triangle corners, as produced by
+  *     the STL readers.
+  */
+
+#include "TriangleSoup.h"
+
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkTypeInt32Array.h>
+
+/* Number of triangles handled by each thread */
+static const vtkIdType grainSize = 65536;
+
+vtkSmartPointer<vtkPolyData> TriangleSoup::build(vtkFloatArray* coords) {
+    vtkIdType corners = coords->GetNumberOfTuples();
+    if (corners > VTK_TYPE_INT32_MAX)
+        return nullptr;
+
+    vtkIdType triangles = corners / 3;
+
+    /* 32 bit connectivity halves the memory needed for the cells compared to vtkIdType */
+    vtkSmartPointer<vtkTypeInt32Array> offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(triangles + 1);
+    vtkTypeInt32* offset = offsets->GetPointer(0);
+
+    vtkSmartPointer<vtkTypeInt32Array> connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(3 * triangles);
+    vtkTypeInt32* conn = connectivity->GetPointer(0);
+
+    vtkSMPTools::For(0, triangles, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++) {
+            offset[t] = vtkTypeInt32(3 * t);
+            conn[3 * t] = vtkTypeInt32(3 * t);
+            conn[3 * t + 1] = vtkTypeInt32(3 * t + 1);
+            conn[3 * t + 2] = vtkTypeInt32(3 * t + 2);
+        }
+    });
+    offset[triangles] = vtkTypeInt32(3 * triangles);
+
+    vtkSmartPointer<vtkPoints> pts = vtkSmartPointer<vtkPoints>::New();
+    pts->SetData(coords);
+
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(pts);
+    output->SetPolys(polys);
+    return output;
+}
@@ -0,0 +1,26 @@
+/**     @file TriangleSoup.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Builds polydata from a flat list of triangle corners, as produced by
+  *     the STL readers.
+  */
+
+#ifndef VIEWER_TRIANGLESOUP_H
+#define VIEWER_TRIANGLESOUP_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkFloatArray.h>
+
+class TriangleSoup {
+public:
+    /** Build polydata where every 3 consecutive points form a triangle.
+      * The cell arrays use 32 bit offsets/connectivity and are filled in parallel.
+      * @param coords holds 3 components per point, 3 points per triangle
+      * @return the geometry, or nullptr if there are too many points for 32 bit indices
+      */
+    static vtkSmartPointer<vtkPolyData> build(vtkFloatArray* coords);
+};
+
+#endif
@@ -0,0 +1,29 @@
+/**     @file VRBackend.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     The window, camera and interactor the VR thread draws with, so the
+  *     same render loop can drive a headset or an offscreen stand-in.
+  */
+
+#include "VRBackend.h"
+#include "OffscreenVRBackend.h"
+#ifdef VIEWER_OPENVR
+#include "OpenVRBackend.h"
+#endif
+
+#include <QDebug>
+
+std::unique_ptr<VRBackend> VRBackend::create(const QString& name, int frameLimit) {
+    if (name == "offscreen")
+        return std::make_unique<OffscreenVRBackend>(frameLimit);
+
+#ifdef VIEWER_OPENVR
+    if (name != "openvr")
+        qWarning() << "Unknown VR backend" << name << "- using OpenVR";
+    return std::make_unique<OpenVRBackend>();
+#else
+    qWarning() << "Built without OpenVR, VR backend" << name << "replaced by the offscreen stand-in";
+    return std::make_unique<OffscreenVRBackend>(frameLimit);
+#endif
+}
@@ -0,0 +1,54 @@
+/**     @file VRBackend.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     The window, camera and interactor the VR thread draws with, so the
+  *     same render loop can drive a headset or an offscreen stand-in.
+  */
+
+#ifndef VIEWER_VRBACKEND_H
+#define VIEWER_VRBACKEND_H
+
+#include <QString>
+#include <vtkRenderer.h>
+
+#include <memory>
+
+/* VRRenderThread owns one backend and calls it only from the VR thread,
+ * apart from construction. The thread fills the renderer from
+ * createRenderer() with actors, then calls start(), then doOneEvent()
+ * once per frame until done() or it is asked to stop, then finish(). */
+class VRBackend {
+public:
+    virtual ~VRBackend() = default;
+
+    /** Make the renderer the scene is added to, before start()
+      * @return the renderer, kept alive by the backend
+      */
+    virtual vtkRenderer* createRenderer() = 0;
+
+    /** Make the window, camera and interactor and draw the first frame */
+    virtual void start() = 0;
+
+    /** Handle input and draw both eyes for one frame */
+    virtual void doOneEvent() = 0;
+
+    /** Check whether the backend has ended the session by itself
+      * @return true once the loop should stop
+      */
+    virtual bool done() const = 0;
+
+    /** Called once the loop has stopped */
+    virtual void finish() {}
+
+    /** Make a backend by name
+      * @param name is "openvr" for the headset or "offscreen" for the stand-in,
+      *        a build without OpenVR always gives the stand-in
+      * @param frameLimit is the number of frames the stand-in draws before
+      *        ending the session, 0 to run until stopped
+      * @return the backend
+      */
+    static std::unique_ptr<VRBackend> create(const QString& name, int frameLimit = 0);
+};
+
+#endif
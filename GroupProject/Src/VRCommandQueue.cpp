@@ -0,0 +1,152 @@
+/**     @file VRCommandQueue.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Typed commands for the VR thread and a bounded lock-free queue that
+  *     carries them over from any number of other threads.
+  */
+
+#include "VRCommandQueue.h"
+
+#include <vtkPlane.h>
+
+#include <algorithm>
+
+VRCommand VRCommand::endRender() {
+    VRCommand command;
+    command.type = EndRender;
+    return command;
+}
+
+VRCommand VRCommand::rotate(int axis, double degrees) {
+    VRCommand command;
+    command.type = Rotate;
+    command.axis = axis;
+    command.values[0] = degrees;
+    return command;
+}
+
+VRCommand VRCommand::transform(vtkActor* actor, const double matrix[16]) {
+    VRCommand command;
+    command.type = Transform;
+    command.actor = actor;
+    std::copy(matrix, matrix + 16, command.matrix);
+    return command;
+}
+
+VRCommand VRCommand::colour(vtkActor* actor, double r, double g, double b) {
+    VRCommand command;
+    command.type = Colour;
+    command.actor = actor;
+    command.values[0] = r;
+    command.values[1] = g;
+    command.values[2] = b;
+    return command;
+}
+
+VRCommand VRCommand::visibility(vtkActor* actor, bool visible) {
+    VRCommand command;
+    command.type = Visibility;
+    command.actor = actor;
+    command.visible = visible;
+    return command;
+}
+
+VRCommand VRCommand::addActor(vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    VRCommand command;
+    command.type = AddActor;
+    command.actor = actor;
+    command.levels = levels;
+    return command;
+}
+
+VRCommand VRCommand::removeActor(vtkActor* actor) {
+    VRCommand command;
+    command.type = RemoveActor;
+    command.actor = actor;
+    return command;
+}
+
+VRCommand VRCommand::geometryChange(vtkActor* actor, vtkPolyData* geometry,
+                                    const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    VRCommand command;
+    command.type = Geometry;
+    command.actor = actor;
+    command.geometry = geometry;
+    command.levels = levels;
+    return command;
+}
+
+/* The plane is read here, the VR thread makes a plane of its own from the copy */
+VRCommand VRCommand::sectionPlane(vtkActor* actor, vtkPlane* plane) {
+    VRCommand command;
+    command.type = SectionPlane;
+    command.actor = actor;
+    command.sectioned = plane != nullptr;
+    if (plane != nullptr) {
+        plane->GetOrigin(command.values);
+        plane->GetNormal(command.normal);
+    }
+    return command;
+}
+
+VRCommandQueue::VRCommandQueue(size_t capacity)
+    : writePosition(0), readPosition(0) {
+    size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+
+    /* A slot is free for the push at position p when its sequence is p */
+    for (size_t i = 0; i < size; i++)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool VRCommandQueue::push(VRCommand&& command) {
+    size_t position = writePosition.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    for (;;) {
+        slot = &slots[position & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        ptrdiff_t difference = ptrdiff_t(sequence) - ptrdiff_t(position);
+
+        if (difference == 0) {
+            /* Free, claim it unless another producer got there first */
+            if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            /* Still holds the command from a lap ago, the consumer is behind */
+            return false;
+        } else {
+            /* Another producer claimed it, try the new write position */
+            position = writePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->command = std::move(command);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool VRCommandQueue::pop(VRCommand& command) {
+    Slot* slot = &slots[readPosition & mask];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence != readPosition + 1)
+        return false;
+
+    /* Reset the slot so it does not keep actors or geometry alive */
+    command = std::move(slot->command);
+    slot->command = VRCommand();
+
+    /* Free for the push one lap from now */
+    slot->sequence.store(readPosition + mask + 1, std::memory_order_release);
+    readPosition++;
+    return true;
+}
+
+size_t VRCommandQueue::capacity() const {
+    return mask + 1;
+}
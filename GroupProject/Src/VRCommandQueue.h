@@ -0,0 +1,125 @@
+/**     @file VRCommandQueue.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Typed commands for the VR thread and a bounded lock-free queue that
+  *     carries them over from any number of other threads.
+  */
+
+#ifndef VIEWER_VRCOMMANDQUEUE_H
+#define VIEWER_VRCOMMANDQUEUE_H
+
+#include <QList>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+class vtkPlane;
+
+/* One change to the VR scene. Actors are the VR thread's own, other threads
+ * only use them to say which actor a command is for. Geometry is shared with
+ * the desktop view and read by both threads, see SharedGeometry. */
+struct VRCommand {
+    /** What the command does */
+    enum Type {
+        None,
+        EndRender,      /**< Stop rendering and let the thread finish */
+        Rotate,         /**< Spin every actor, values[0] degrees per step about axis */
+        Transform,      /**< Set actor's own transform to matrix, on top of its VR placement */
+        Colour,         /**< Set actor's colour to values[0..2], 0 to 1 */
+        Visibility,     /**< Show or hide actor */
+        AddActor,       /**< Add actor, with levels of detail in levels */
+        RemoveActor,    /**< Take actor out of the scene */
+        Geometry,       /**< Draw geometry for actor, e.g. after a filter change */
+        SectionPlane    /**< Cut actor open at the plane through values with normal, or not at all */
+    };
+
+    Type                                    type = None;
+    vtkSmartPointer<vtkActor>               actor;
+    int                                     axis = 0;           /**< 0, 1 or 2 for X, Y or Z */
+    double                                  values[3] = { 0.0, 0.0, 0.0 };
+    double                                  matrix[16];         /**< Row major 4x4 */
+    bool                                    visible = true;
+    double                                  normal[3] = { 0.0, 0.0, 1.0 };
+    bool                                    sectioned = false;  /**< For SectionPlane, false to stop cutting */
+    vtkSmartPointer<vtkPolyData>            geometry;
+    QList<vtkSmartPointer<vtkPolyData>>     levels;             /**< Coarser copies of the geometry, finest first */
+
+    /** @return a command to stop rendering */
+    static VRCommand endRender();
+
+    /** @return a command to spin every actor by degrees per step about an axis */
+    static VRCommand rotate(int axis, double degrees);
+
+    /** @return a command to set an actor's transform, a row major 4x4 matrix */
+    static VRCommand transform(vtkActor* actor, const double matrix[16]);
+
+    /** @return a command to set an actor's colour */
+    static VRCommand colour(vtkActor* actor, double r, double g, double b);
+
+    /** @return a command to show or hide an actor */
+    static VRCommand visibility(vtkActor* actor, bool visible);
+
+    /** @return a command to add an actor along with its levels of detail */
+    static VRCommand addActor(vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** @return a command to remove an actor */
+    static VRCommand removeActor(vtkActor* actor);
+
+    /** @return a command to draw new geometry for an actor */
+    static VRCommand geometryChange(vtkActor* actor, vtkPolyData* geometry,
+                                    const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** @return a command to cut an actor open where a plane is now, nullptr to stop */
+    static VRCommand sectionPlane(vtkActor* actor, vtkPlane* plane);
+};
+
+/* A fixed size ring of slots, each with a sequence number saying whether it
+ * is free for the next push or holds the next command to pop. Producers
+ * claim a slot by advancing the write position with a compare-and-swap,
+ * so any number of threads can push at once without a lock, and a command
+ * is only seen by the consumer once it has been written in full. There is
+ * a single consumer, the VR thread. */
+class VRCommandQueue {
+public:
+    /** Constructor
+      * @param capacity is rounded up to a power of two
+      */
+    VRCommandQueue(size_t capacity = 1024);
+
+    /** Add a command, from any thread
+      * @param command is the command, moved from if it is queued
+      * @return false if the queue is full
+      */
+    bool push(VRCommand&& command);
+
+    /** Take the oldest command, from the consumer thread only
+      * @param command is set to the command
+      * @return false if the queue is empty
+      */
+    bool pop(VRCommand& command);
+
+    /** Get the number of commands the queue can hold
+      * @return the capacity
+      */
+    size_t capacity() const;
+
+private:
+    struct Slot {
+        std::atomic<size_t>     sequence;
+        VRCommand               command;
+    };
+
+    std::unique_ptr<Slot[]>     slots;
+    size_t                      mask;
+
+    /* Kept on separate cache lines so producers and the consumer do not slow each other down */
+    alignas(64) std::atomic<size_t>  writePosition;
+    alignas(64) size_t               readPosition;
+};
+
+#endif
@@ -0,0 +1,287 @@
+/**     @file VRFrameGovernor.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps VR frames inside the headset's frame time by drawing less when
+  *     frames run long and more again when there is time to spare.
+  */
+
+#include "VRFrameGovernor.h"
+
+#include <QDebug>
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkMath.h>
+#include <vtkPlaneCollection.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+
+#include <algorithm>
+#include <cmath>
+
+const VRFrameGovernor::Tier VRFrameGovernor::tiers[] = {
+    { false, 1.0,   0.0 },
+    { true,  1.0,   0.0 },
+    { true,  0.5,   0.0 },
+    { true,  0.25,  2.0 },
+    { true,  0.1,   6.0 },
+    { true,  0.03,  16.0 },
+};
+const int VRFrameGovernor::tierCount = sizeof(tiers) / sizeof(tiers[0]);
+
+/* Triangles a part may use for each pixel of its size in the headset, squared */
+static const double trianglesPerPixel = 0.5;
+
+/* Headsets do not report a view angle through the camera, this is typical */
+static const double headsetViewAngle = 100.0;
+
+/* Frames over budget before drawing less, and with time to spare before drawing more */
+static const int framesToDegrade = 5;
+static const int framesToRestore = 90;
+
+/* Drawing more is only tried when the average is this far inside the budget */
+static const double restoreFraction = 0.7;
+
+VRFrameGovernor::VRFrameGovernor(double budgetMilliseconds)
+    : budget(budgetMilliseconds) {
+}
+
+VRFrameGovernor::~VRFrameGovernor() {
+    if (renderer != nullptr) {
+        renderer->RemoveObserver(startTag);
+        renderer->RemoveObserver(endTag);
+    }
+}
+
+void VRFrameGovernor::addActor(vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    Part part;
+    part.actor = actor;
+
+    /* Hidden parts arrive hidden, culling must not bring them back */
+    part.visible = actor->GetVisibility();
+
+    vtkSmartPointer<vtkProperty> property = vtkSmartPointer<vtkProperty>::New();
+    property->DeepCopy(actor->GetProperty());
+    actor->SetProperty(property);
+    part.interpolation = property->GetInterpolation();
+    part.specular = property->GetSpecular();
+    part.backfaceCulling = property->GetBackfaceCulling();
+
+    vtkMapper* full = actor->GetMapper();
+    vtkDataSet* input = full != nullptr ? full->GetInput() : nullptr;
+    part.mappers.push_back(full);
+    part.cells.push_back(input != nullptr ? input->GetNumberOfCells() : 0);
+    addLevels(part, levels);
+
+    /* Actors added while running join in at the current tier */
+    if (shadingCut)
+        applyShading(part, true);
+    parts.insert(actor, part);
+}
+
+/* Each level has a mapper of its own so switching does not upload anything */
+void VRFrameGovernor::addLevels(Part& part, const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    vtkMapper* full = part.mappers.front();
+    for (const vtkSmartPointer<vtkPolyData>& level : levels) {
+        vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(level);
+        if (full != nullptr)
+            mapper->SetClippingPlanes(full->GetClippingPlanes());
+        part.mappers.push_back(mapper);
+        part.cells.push_back(level->GetNumberOfCells());
+    }
+}
+
+void VRFrameGovernor::removeActor(vtkActor* actor) {
+    parts.remove(actor);
+}
+
+void VRFrameGovernor::setGeometry(vtkActor* actor, vtkPolyData* geometry, const QList<vtkSmartPointer<vtkPolyData>>& levels) {
+    auto it = parts.find(actor);
+    if (it == parts.end()) {
+        if (actor->GetMapper() != nullptr)
+            actor->GetMapper()->SetInputDataObject(geometry);
+        return;
+    }
+
+    /* Levels arriving for the geometry already drawn do not upload it again,
+     * shared copies of the same geometry share its points and cells */
+    Part& part = it.value();
+    vtkMapper* full = part.mappers.front();
+    vtkPolyData* current = full != nullptr ? vtkPolyData::SafeDownCast(full->GetInput()) : nullptr;
+    bool same = current != nullptr && current->GetPoints() == geometry->GetPoints() && current->GetPolys() == geometry->GetPolys();
+    if (full != nullptr && !same)
+        full->SetInputDataObject(geometry);
+    part.mappers.resize(1);
+    part.cells.assign(1, geometry->GetNumberOfCells());
+    addLevels(part, levels);
+
+    part.level = 0;
+    actor->SetMapper(full);
+}
+
+/* Every level shares one collection, as levels added later do */
+void VRFrameGovernor::setSectionPlane(vtkActor* actor, vtkPlane* plane) {
+    vtkSmartPointer<vtkPlaneCollection> planes;
+    if (plane != nullptr) {
+        planes = vtkSmartPointer<vtkPlaneCollection>::New();
+        planes->AddItem(plane);
+    }
+
+    auto it = parts.find(actor);
+    if (it == parts.end()) {
+        if (actor->GetMapper() != nullptr)
+            actor->GetMapper()->SetClippingPlanes(planes);
+        return;
+    }
+    for (const vtkSmartPointer<vtkMapper>& mapper : it->mappers)
+        mapper->SetClippingPlanes(planes);
+}
+
+void VRFrameGovernor::setVisible(vtkActor* actor, bool visible) {
+    auto it = parts.find(actor);
+    if (it == parts.end()) {
+        actor->SetVisibility(visible);
+        return;
+    }
+
+    it->visible = visible;
+    actor->SetVisibility(visible && !it->culled);
+}
+
+void VRFrameGovernor::clear() {
+    parts.clear();
+}
+
+void VRFrameGovernor::attach(vtkRenderer* vrRenderer) {
+    renderer = vrRenderer;
+    startTag = renderer->AddObserver(vtkCommand::StartEvent, this, &VRFrameGovernor::renderStarted);
+    endTag = renderer->AddObserver(vtkCommand::EndEvent, this, &VRFrameGovernor::renderEnded);
+}
+
+/* Only the renderer's own passes are timed, not the wait for the headset
+ * to be ready for the next frame, which would make every frame look full */
+void VRFrameGovernor::renderStarted() {
+    passStart = std::chrono::steady_clock::now();
+}
+
+void VRFrameGovernor::renderEnded() {
+    frameTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+}
+
+/**
+ * @brief Updates the average render time and moves between tiers.
+ *
+ * A frame with no render passes, e.g. while the headset is idle, is not
+ * counted.
+ */
+void VRFrameGovernor::frameDone() {
+    if (renderer == nullptr || frameTime <= 0.0)
+        return;
+
+    average = average > 0.0 ? 0.9 * average + 0.1 * frameTime : frameTime;
+    frameTime = 0.0;
+
+    overFrames = average > budget ? overFrames + 1 : 0;
+    underFrames = average < budget * restoreFraction ? underFrames + 1 : 0;
+
+    if (overFrames >= framesToDegrade && tier + 1 < tierCount)
+        setTier(tier + 1, average);
+    else if (underFrames >= framesToRestore && tier > 0)
+        setTier(tier - 1, average);
+
+    selectDetail();
+}
+
+void VRFrameGovernor::setTier(int newTier, double averageMilliseconds) {
+    const Tier& t = tiers[newTier];
+    qInfo().noquote() << QString("VR governor: render %1 ms against %2 ms budget, tier %3 -> %4 "
+                                 "(cheap shading %5, detail %6%, culling parts under %7 px)")
+                         .arg(averageMilliseconds, 0, 'f', 1).arg(budget, 0, 'f', 1)
+                         .arg(tier).arg(newTier).arg(t.cheapShading ? "on" : "off")
+                         .arg(int(t.detail * 100.0)).arg(t.cullPixels);
+
+    tier = newTier;
+    overFrames = 0;
+    underFrames = 0;
+
+    if (t.cheapShading != shadingCut)
+        applyShading(t.cheapShading);
+
+    /* Report what the new tier does to the scene */
+    selectDetail();
+    int coarser = 0, culled = 0;
+    for (const Part& part : parts) {
+        if (part.culled)
+            culled++;
+        else if (part.level > 0)
+            coarser++;
+    }
+    qInfo().noquote() << QString("VR governor: %1 of %2 parts at a coarser level, %3 not drawn")
+                         .arg(coarser).arg(parts.size()).arg(culled);
+}
+
+void VRFrameGovernor::applyShading(bool cheap) {
+    shadingCut = cheap;
+    for (Part& part : parts)
+        applyShading(part, cheap);
+}
+
+void VRFrameGovernor::applyShading(Part& part, bool cheap) {
+    vtkProperty* property = part.actor->GetProperty();
+    if (cheap) {
+        property->SetInterpolationToFlat();
+        property->SetSpecular(0.0);
+        property->BackfaceCullingOn();
+    } else {
+        property->SetInterpolation(part.interpolation);
+        property->SetSpecular(part.specular);
+        property->SetBackfaceCulling(part.backfaceCulling);
+    }
+}
+
+/**
+ * @brief Picks each part's level and whether it is drawn at all.
+ *
+ * Works like the desktop's level of detail: the finest level whose
+ * triangle count fits the part's size on screen, squared, scaled by the
+ * tier's detail.
+ */
+void VRFrameGovernor::selectDetail() {
+    if (renderer == nullptr)
+        return;
+
+    const Tier& t = tiers[tier];
+    double eye[3];
+    renderer->GetActiveCamera()->GetPosition(eye);
+    double height = std::max(1, renderer->GetSize()[1]);
+    double pixelsPerUnit = height / (2.0 * std::tan(vtkMath::RadiansFromDegrees(headsetViewAngle) / 2.0));
+
+    for (Part& part : parts) {
+        double bounds[6], centre[3];
+        part.actor->GetBounds(bounds);
+        for (int i = 0; i < 3; i++)
+            centre[i] = (bounds[2 * i] + bounds[2 * i + 1]) / 2.0;
+        double corner[3] = { bounds[1], bounds[3], bounds[5] };
+        double radius = std::sqrt(vtkMath::Distance2BetweenPoints(centre, corner));
+        double distance = std::sqrt(vtkMath::Distance2BetweenPoints(eye, centre));
+
+        /* Inside or touching the part it fills the view */
+        double pixels = distance > radius ? 2.0 * radius * pixelsPerUnit / distance : height;
+        double budgetCells = pixels * pixels * trianglesPerPixel * t.detail;
+
+        int level = 0;
+        while (level + 1 < int(part.mappers.size()) && part.cells[level] > budgetCells)
+            level++;
+        if (level != part.level) {
+            part.level = level;
+            part.actor->SetMapper(part.mappers[level]);
+        }
+
+        bool culled = pixels < t.cullPixels;
+        if (culled != part.culled) {
+            part.culled = culled;
+            part.actor->SetVisibility(part.visible && !culled);
+        }
+    }
+}
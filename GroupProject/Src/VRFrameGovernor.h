@@ -0,0 +1,144 @@
+/**     @file VRFrameGovernor.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps VR frames inside the headset's frame time by drawing less when
+  *     frames run long and more again when there is time to spare.
+  */
+
+#ifndef VIEWER_VRFRAMEGOVERNOR_H
+#define VIEWER_VRFRAMEGOVERNOR_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkMapper.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+
+#include <chrono>
+#include <vector>
+
+/* Works through a fixed ladder of tiers, each drawing less than the one
+ * before: cheaper shading first, then coarser levels of detail for every
+ * part, then leaving out parts that are only a few pixels across. The tier
+ * goes up as soon as the average render time has been over budget for a
+ * few frames, and only comes down after a second well inside it, so it
+ * settles rather than flickering. Levels are still picked per part every
+ * frame from its size in the headset view. Every tier change is logged
+ * with the frame time that caused it. Only used on the VR thread, apart
+ * from addActor() and clear() which are called before it starts. */
+class VRFrameGovernor {
+public:
+    /** Constructor
+      * @param budgetMilliseconds is the render time to stay inside, e.g. 11 for 90 Hz
+      */
+    VRFrameGovernor(double budgetMilliseconds = 11.0);
+
+    /** Destructor, stops timing the renderer */
+    ~VRFrameGovernor();
+
+    /** Take charge of an actor's detail. The actor is given its own copy of
+      * its property, so shading can be cut without touching anything shared.
+      * @param actor is the full resolution actor
+      * @param levels are coarser copies of its geometry, finest first, may be empty
+      */
+    void addActor(vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** Stop managing an actor
+      * @param actor is the actor
+      */
+    void removeActor(vtkActor* actor);
+
+    /** Give an actor new geometry, replacing its levels of detail
+      * @param actor is the actor
+      * @param geometry is the full resolution geometry
+      * @param levels are coarser copies of it, finest first, may be empty
+      */
+    void setGeometry(vtkActor* actor, vtkPolyData* geometry, const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** Cut an actor open at a plane, at every level of detail
+      * @param actor is the actor
+      * @param plane is the plane, nullptr to draw the actor whole
+      */
+    void setSectionPlane(vtkActor* actor, vtkPlane* plane);
+
+    /** Show or hide an actor, it stays hidden while culled whatever this says
+      * @param actor is the actor
+      * @param visible is false to hide it
+      */
+    void setVisible(vtkActor* actor, bool visible);
+
+    /** Forget every actor */
+    void clear();
+
+    /** Start timing the renderer's passes, called once it has been created
+      * @param renderer is the VR renderer, drawn once per eye each frame
+      */
+    void attach(vtkRenderer* renderer);
+
+    /** Account for the frame just drawn and set up the next one, called
+      * once per pass of the VR event loop */
+    void frameDone();
+
+private:
+    /* What each tier leaves out */
+    struct Tier {
+        bool        cheapShading;   /**< Flat shading, no specular, back faces culled */
+        double      detail;         /**< Scale on each part's triangle budget */
+        double      cullPixels;     /**< Parts smaller than this on screen are not drawn */
+    };
+
+    /* An actor and what it can be drawn with */
+    struct Part {
+        vtkSmartPointer<vtkActor>               actor;
+        std::vector<vtkSmartPointer<vtkMapper>> mappers;    /**< Full resolution first, then each coarser level */
+        std::vector<vtkIdType>                  cells;      /**< Cells drawn by each mapper */
+        int                                     level = 0;  /**< Mapper in use */
+        bool                                    culled = false;
+        bool                                    visible = true; /**< Shown as far as the user is concerned */
+        int                                     interpolation;  /**< Shading to restore */
+        double                                  specular;
+        bool                                    backfaceCulling;
+    };
+
+    /** Move to another tier and log why */
+    void setTier(int tier, double averageMilliseconds);
+
+    /** Switch every part's shading between its own and the cheap one */
+    void applyShading(bool cheap);
+
+    /** Switch one part's shading between its own and the cheap one */
+    static void applyShading(Part& part, bool cheap);
+
+    /** Make a mapper for each coarser level of a part */
+    static void addLevels(Part& part, const QList<vtkSmartPointer<vtkPolyData>>& levels);
+
+    /** Pick each part's level and whether it is drawn, for the current tier */
+    void selectDetail();
+
+    void renderStarted();
+    void renderEnded();
+
+    static const Tier                       tiers[];
+    static const int                        tierCount;
+
+    double                                  budget;             /**< Milliseconds */
+    QHash<vtkActor*, Part>                  parts;
+    vtkRenderer*                            renderer = nullptr;
+    unsigned long                           startTag = 0;
+    unsigned long                           endTag = 0;
+
+    std::chrono::steady_clock::time_point   passStart;
+    double                                  frameTime = 0.0;    /**< Milliseconds spent rendering this frame, all eyes */
+    double                                  average = 0.0;      /**< Smoothed render time, milliseconds */
+    int                                     overFrames = 0;     /**< Frames in a row with the average over budget */
+    int                                     underFrames = 0;    /**< Frames in a row with time to spare */
+    int                                     tier = 0;
+    bool                                    shadingCut = false;
+};
+
+#endif
@@ -12,10 +12,6 @@
 
 /* Vtk headers */
 #include <vtkActor.h>
-#include <vtkOpenVRRenderWindow.h>				
-#include <vtkOpenVRRenderWindowInteractor.h>	
-#include <vtkOpenVRRenderer.h>					
-#include <vtkOpenVRCamera.h>	
 
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
@@ -24,8 +20,10 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkSTLReader.h>
-#include <vtkDataSetmapper.h>
+#include <vtkDataSetMapper.h>
 #include <vtkCallbackCommand.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPlane.h>
 
 
 /* The class constructor is called by MainWindow and runs in the primary program thread, this thread
@@ -33,9 +31,10 @@
  * in the constructor, as it will take control of the main thread to handle the VR interaction (headset 
  * rotation etc. This means that a second thread is needed to handle the VR.
  */
-VRRenderThread::VRRenderThread( QObject* parent ) {
+VRRenderThread::VRRenderThread( QObject* parent, std::unique_ptr<VRBackend> backend )
+	: backend(backend ? std::move(backend) : VRBackend::create("openvr")) {
 	/* Initialise actor list */
-	actors = vtkActorCollection::New();
+	actors = vtkSmartPointer<vtkActorCollection>::New();
 
 	/* Initialise command variables */
 	rotateX = 0.;
@@ -54,7 +53,7 @@ VRRenderThread::~VRRenderThread() {
 }
 
 
-void VRRenderThread::addActorOffline( vtkActor* actor ) {
+void VRRenderThread::addActorOffline( vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels ) {
 	// Null check
 	if (actor == nullptr) {
 		std::cout << "Error: actor is null" << std::endl;
@@ -62,44 +61,125 @@ void VRRenderThread::addActorOffline( vtkActor* actor ) {
 	}
 	/* Check to see if render thread is running */
 	if (!this->isRunning()) {
-		
-		double* ac = actor->GetOrigin();
-	
-		/* I have found that these initial transforms will position the FS
-		 * car model in a sensible position but you can experiment
-		 */
-		actor->RotateX(-90);
-		actor->AddPosition(-ac[0]+0, -ac[1]-100, -ac[2]-200);
-
+		placeActor(actor);
 		actors->AddItem(actor);
+		governor.addActor(actor, levels);
+	} else {
+		issueCommand(VRCommand::addActor(actor, levels));
 	}
 }
 
 
+void VRRenderThread::placeActor( vtkActor* actor ) {
+	double* ac = actor->GetOrigin();
+
+	/* I have found that these initial transforms will position the FS
+	 * car model in a sensible position but you can experiment
+	 */
+	actor->RotateX(-90);
+	actor->AddPosition(-ac[0]+0, -ac[1]-100, -ac[2]-200);
+}
+
+
 void VRRenderThread::removeAllActors() {
 	actors->RemoveAllItems();
+	governor.clear();
 }
 
 
 void VRRenderThread::issueCommand( int cmd, double value ) {
 
-	/* Update class variables according to command */
+	/* Translate to a typed command, the render loop applies it */
 	switch (cmd) {
 		/* These are just a few basic examples */
 		case END_RENDER:
-			this->endRender = true;
+			issueCommand(VRCommand::endRender());
 			break;
 
 		case ROTATE_X:
-			this->rotateX = value;
+			issueCommand(VRCommand::rotate(0, value));
 			break;
 
 		case ROTATE_Y:
-			this->rotateY = value;
+			issueCommand(VRCommand::rotate(1, value));
 			break;
 
 		case ROTATE_Z:
-			this->rotateZ = value;
+			issueCommand(VRCommand::rotate(2, value));
+			break;
+	}
+}
+
+
+void VRRenderThread::issueCommand( VRCommand command ) {
+	/* The render loop empties the queue every frame, so a full queue only
+	 * means a burst of edits, wait for the next frame to make room. With no
+	 * render loop to wait for there is nobody to apply it anyway. */
+	while (!commands.push(std::move(command))) {
+		if (!this->isRunning()) {
+			std::cout << "Error: VR command queue is full and VR is not running" << std::endl;
+			return;
+		}
+		QThread::yieldCurrentThread();
+	}
+}
+
+
+/* Runs on the VR thread, the only place the VR scene is changed once it is running */
+void VRRenderThread::applyCommand( VRCommand& command ) {
+	vtkActor* actor = command.actor;
+
+	switch (command.type) {
+		case VRCommand::EndRender:
+			endRender = true;
+			break;
+
+		case VRCommand::Rotate:
+			(command.axis == 0 ? rotateX : command.axis == 1 ? rotateY : rotateZ) = command.values[0];
+			break;
+
+		case VRCommand::Transform: {
+			vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+			matrix->DeepCopy(command.matrix);
+			actor->SetUserMatrix(matrix);
+			break;
+		}
+
+		case VRCommand::Colour:
+			actor->GetProperty()->SetColor(command.values);
+			break;
+
+		case VRCommand::Visibility:
+			governor.setVisible(actor, command.visible);
+			break;
+
+		case VRCommand::AddActor:
+			placeActor(actor);
+			renderer->AddActor(actor);
+			governor.addActor(actor, command.levels);
+			break;
+
+		case VRCommand::RemoveActor:
+			renderer->RemoveActor(actor);
+			governor.removeActor(actor);
+			break;
+
+		case VRCommand::Geometry:
+			governor.setGeometry(actor, command.geometry, command.levels);
+			break;
+
+		case VRCommand::SectionPlane: {
+			vtkSmartPointer<vtkPlane> plane;
+			if (command.sectioned) {
+				plane = vtkSmartPointer<vtkPlane>::New();
+				plane->SetOrigin(command.values);
+				plane->SetNormal(command.normal);
+			}
+			governor.setSectionPlane(actor, plane);
+			break;
+		}
+
+		case VRCommand::None:
 			break;
 	}
 }
@@ -125,9 +205,10 @@ void VRRenderThread::run() {
 	// The renderer generates the image
 	// which is then displayed on the render window.
 	// It can be thought of as a scene to which the actor is added
-	renderer = vtkOpenVRRenderer::New();	
+	renderer = backend->createRenderer();
 	
 	renderer->SetBackground(colors->GetColor3d("BkgColor").GetData());
+	governor.attach(renderer);
 	
 	/* Loop through list of actors provided and add to scene */
 	vtkActor* a;
@@ -136,26 +217,10 @@ void VRRenderThread::run() {
 		renderer->AddActor(a);
 	}
 
-	/* The render window is the actual GUI window
-	 * that appears on the computer screen
-	 */
-	window = vtkOpenVRRenderWindow::New();
-
-	window->Initialize();
-	window->AddRenderer(renderer);
-	
-	/* Create Open VR Camera */
-	camera = vtkOpenVRCamera::New();				
-	renderer->SetActiveCamera(camera);			
-
-	/* The render window interactor captures mouse events
-	 * and will perform appropriate camera or actor manipulation
-	 * depending on the nature of the events.
+	/* The backend makes the window, camera and interactor, for the headset
+	 * or a stand-in, and draws the first frame
 	 */
-	interactor = vtkOpenVRRenderWindowInteractor::New();									
-	interactor->SetRenderWindow(window);													
-	interactor->Initialize();
-	window->Render();
+	backend->start();
 	
 
 	/* Now start the VR - we will implement the command loop manually
@@ -165,8 +230,18 @@ void VRRenderThread::run() {
 	endRender = false;
 	t_last = std::chrono::steady_clock::now();
 
-	while( !interactor->GetDone() && !this->endRender ) {
-		interactor->DoOneEvent( window, renderer );
+	while( !backend->done() && !this->endRender ) {
+		/* Apply every change issued since the last frame before drawing the
+		 * next, however many arrived. The limit stops a producer that never
+		 * pauses from holding up the headset. */
+		VRCommand command;
+		for (size_t i = 0; i < commands.capacity() && commands.pop(command); i++)
+			applyCommand(command);
+
+		backend->doOneEvent();
+
+		/* Measure the frame just drawn and cut or restore detail to suit */
+		governor.frameDone();
 
 		/* Check to see if enough time has elapsed since last update 
 		 * This looks overcomplicated (and it is, C++ loves to make things unecessarily complicated!) but
@@ -207,13 +282,13 @@ void VRRenderThread::run() {
 			t_last = std::chrono::steady_clock::now();
 		}
 	}
+
+	backend->finish();
 }
 
 void VRRenderThread::stop() {
-	/* Set the endRender flag to true, this will cause the VR thread to exit */
-	if (this != nullptr) {
-		endRender = true;
-	}
+	/* Ask the render loop to set its endRender flag, this will cause the VR thread to exit */
+	issueCommand(VRCommand::endRender());
 }
 
 
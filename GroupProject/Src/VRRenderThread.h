@@ -10,18 +10,16 @@
 #define VR_RENDER_THREAD_H
 
 /* Project headers */
+#include "VRFrameGovernor.h"
+#include "VRCommandQueue.h"
+#include "VRBackend.h"
 
 /* Qt headers */
 #include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
 
 /* Vtk headers */
 #include <vtkActor.h>
-#include <vtkOpenVRRenderWindow.h>				
-#include <vtkOpenVRRenderWindowInteractor.h>	
-#include <vtkOpenVRRenderer.h>					
-#include <vtkOpenVRCamera.h>	
+#include <vtkRenderer.h>
 #include <vtkActorCollection.h>
 #include <vtkCommand.h>
 
@@ -47,17 +45,22 @@ public:
 
 
     /**  Constructor
+      * @param backend draws the scene, nullptr for the headset through OpenVR
       */
-    VRRenderThread(QObject* parent = nullptr);
+    VRRenderThread(QObject* parent = nullptr, std::unique_ptr<VRBackend> backend = nullptr);
 
     /**  Destructor
       */
     ~VRRenderThread();
 
     /** This allows actors to be added to the VR renderer BEFORE the VR
-      * interactor has been started 
+      * interactor has been started. Once it is running the actor is queued
+      * and added by the VR thread before its next frame instead.
+      * @param actor is the actor to add, the calling thread must not use it afterwards
+      * @param levels are coarser copies of the actor's geometry, finest first,
+      *        drawn instead when frames run long
      */
-    void addActorOffline(vtkActor* actor);
+    void addActorOffline(vtkActor* actor, const QList<vtkSmartPointer<vtkPolyData>>& levels = {});
 
     void removeAllActors();
 
@@ -68,6 +71,14 @@ public:
       */
     void issueCommand( int cmd, double value );
 
+    /** Queue a change to the VR scene, from any thread. Commands are applied
+      * in the order they were issued, all those waiting at the start of a
+      * frame in one go. If the queue is full this waits for the render loop
+      * to make room, so no command is dropped while VR is running.
+      * @param command is the change
+      */
+    void issueCommand( VRCommand command );
+
     void stop();
 
 
@@ -77,29 +88,36 @@ protected:
     void run() override;
 
 private:
-    /* Standard VTK VR Classes */
-    vtkSmartPointer<vtkOpenVRRenderWindow>              window;
-    vtkSmartPointer<vtkOpenVRRenderWindowInteractor>    interactor;
-    vtkSmartPointer<vtkOpenVRRenderer>                  renderer;
-    vtkSmartPointer<vtkOpenVRCamera>                    camera;
+    /* The headset or a stand-in, owns the window, camera and interactor */
+    std::unique_ptr<VRBackend>                          backend;
+    vtkSmartPointer<vtkRenderer>                        renderer;
+
+    /** Apply a command from the queue, on the VR thread */
+    void applyCommand( VRCommand& command );
 
-    /* Use to synchronise passing of data to VR thread */
-    QMutex                                              mutex;      
-    QWaitCondition                                      condition;
+    /** Give an actor its starting place in the VR scene */
+    static void placeActor( vtkActor* actor );
+
+    /* Use to pass changes from the GUI thread to the VR thread */
+    VRCommandQueue                                      commands;
 
     /** List of actors that will need to be added to the VR scene */
     vtkSmartPointer<vtkActorCollection>                 actors;
 
+    /** Draws less when frames take longer than the headset allows */
+    VRFrameGovernor                                     governor;
+
     /** A timer to help implement animations and visual effects */
     std::chrono::time_point<std::chrono::steady_clock>  t_last;
 
-    /** This will be set to false by the constructor, if it is set to true
-      * by the GUI then the rendering will end 
+    /** This will be set to false when rendering starts, an END_RENDER
+      * command from the GUI sets it to true and the rendering will end.
+      * Only used by the VR thread.
       */
     bool                                                endRender;
 
-    /* Some variables to indicate animation actions to apply.
-     *
+    /* Some variables to indicate animation actions to apply, only used by
+     * the VR thread once it is running.
      */
     double rotateX;         /*< Degrees to rotate around X axis (per time-step) */
     double rotateY;         /*< Degrees to rotate around Y axis (per time-step) */
@@ -0,0 +1,133 @@
+/**     @file VRSceneSync.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps the VR scene in step with the model tree while VR is running,
+  *     by sending the VR thread only what has changed about each part.
+  */
+
+#include "VRSceneSync.h"
+#include "ModelPart.h"
+#include "VRRenderThread.h"
+
+#include <vtkMatrix4x4.h>
+#include <vtkProperty.h>
+
+VRSceneSync::VRSceneSync(VRRenderThread* thread)
+    : thread(thread) {
+}
+
+void VRSceneSync::addSubtree(ModelPart* part) {
+    addPart(part);
+    for (int i = 0; i < part->childCount(); i++)
+        addSubtree(part->child(i));
+}
+
+/**
+ * @brief Turns a batch of part changes into VR commands.
+ *
+ * A visibility change is inherited down the tree, so it is sent for the
+ * whole branch. Names and filter settings have nothing to show in VR, the
+ * filter output arrives as a geometry change. Levels of detail built after
+ * the part was added go over with its geometry. Section planes are sent as
+ * they are now, the VR thread cuts with a plane of its own.
+ *
+ * @param changes The parts changed since the last batch and what changed about each.
+ */
+void VRSceneSync::partsChanged(const PartChangeNotifier::Changes& changes) {
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        ModelPart* part = it.key();
+        PartChangeNotifier::Properties properties = it.value();
+
+        if (properties & PartChangeNotifier::Inserted) {
+            addSubtree(part);
+            continue;
+        }
+        if (properties & (PartChangeNotifier::Geometry | PartChangeNotifier::LevelsOfDetail))
+            updateGeometry(part);
+
+        auto actor = actors.constFind(part);
+        if (actor == actors.constEnd()) {
+            /* A group has no actor of its own but its parts inherit its visibility */
+            if (properties & PartChangeNotifier::Visibility)
+                updateVisibility(part);
+            continue;
+        }
+
+        if (properties & PartChangeNotifier::Colour) {
+            QColor colour = part->getColor();
+            thread->issueCommand(VRCommand::colour(actor.value(), colour.redF(), colour.greenF(), colour.blueF()));
+        }
+        if (properties & PartChangeNotifier::Visibility)
+            updateVisibility(part);
+        if (properties & PartChangeNotifier::Position)
+            updatePosition(part);
+        if (properties & PartChangeNotifier::Section)
+            thread->issueCommand(VRCommand::sectionPlane(actor.value(), part->getSectionPlane()));
+    }
+}
+
+void VRSceneSync::clear() {
+    for (const vtkSmartPointer<vtkActor>& actor : actors)
+        thread->issueCommand(VRCommand::removeActor(actor));
+    actors.clear();
+}
+
+/**
+ * @brief Makes a part's VR actor and hands it to the VR thread.
+ *
+ * The actor shares the part's geometry but has its own property, set up
+ * with the part's current colour, position and visibility, since the GUI
+ * thread cannot change it once it has been handed over.
+ *
+ * @param part The part, skipped if it has no geometry yet or already has an actor.
+ */
+void VRSceneSync::addPart(ModelPart* part) {
+    if (actors.contains(part) || part->getShownGeometry() == nullptr)
+        return;
+
+    vtkSmartPointer<vtkActor> actor = part->getNewActor();
+    QColor colour = part->getColor();
+    actor->GetProperty()->SetColor(colour.redF(), colour.greenF(), colour.blueF());
+    actor->SetVisibility(part->isShown());
+
+    QVector3D position = part->getPosition();
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    matrix->SetElement(0, 3, position.x());
+    matrix->SetElement(1, 3, position.y());
+    matrix->SetElement(2, 3, position.z());
+    actor->SetUserMatrix(matrix);
+
+    actors.insert(part, actor);
+    thread->addActorOffline(actor, part->getSharedLevelsOfDetail());
+}
+
+void VRSceneSync::updateGeometry(ModelPart* part) {
+    auto actor = actors.constFind(part);
+    if (actor == actors.constEnd()) {
+        addPart(part);
+        return;
+    }
+
+    vtkSmartPointer<vtkPolyData> geometry = part->getSharedGeometry();
+    if (geometry != nullptr)
+        thread->issueCommand(VRCommand::geometryChange(actor.value(), geometry, part->getSharedLevelsOfDetail()));
+}
+
+void VRSceneSync::updateVisibility(ModelPart* part) {
+    auto actor = actors.constFind(part);
+    if (actor != actors.constEnd())
+        thread->issueCommand(VRCommand::visibility(actor.value(), part->isShown()));
+
+    for (int i = 0; i < part->childCount(); i++)
+        updateVisibility(part->child(i));
+}
+
+void VRSceneSync::updatePosition(ModelPart* part) {
+    QVector3D position = part->getPosition();
+    double matrix[16] = { 1.0, 0.0, 0.0, position.x(),
+                          0.0, 1.0, 0.0, position.y(),
+                          0.0, 0.0, 1.0, position.z(),
+                          0.0, 0.0, 0.0, 1.0 };
+    thread->issueCommand(VRCommand::transform(actors.value(part), matrix));
+}
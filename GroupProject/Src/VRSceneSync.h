@@ -0,0 +1,67 @@
+/**     @file VRSceneSync.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Keeps the VR scene in step with the model tree while VR is running,
+  *     by sending the VR thread only what has changed about each part.
+  */
+
+#ifndef VIEWER_VRSCENESYNC_H
+#define VIEWER_VRSCENESYNC_H
+
+#include <QHash>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+
+#include "PartChangeNotifier.h"
+
+class ModelPart;
+class VRRenderThread;
+
+/* Each part with geometry has one VR actor, made on the GUI thread sharing
+ * the part's geometry and handed over to the VR thread. After that
+ * the GUI thread never touches the actor: changes reported by the parts are
+ * collected per event loop pass by PartChangeNotifier, turned into one
+ * command per part and property, and applied by the VR thread before its
+ * next frame. Geometry is shared, never copied. Only used on the GUI
+ * thread. */
+class VRSceneSync {
+public:
+    /** Constructor
+      * @param thread is the VR thread, it must outlive this
+      */
+    VRSceneSync(VRRenderThread* thread);
+
+    /** Give a part and every part below it with geometry a VR actor, either
+      * before the VR thread starts or while it runs
+      * @param part is the root of the branch
+      */
+    void addSubtree(ModelPart* part);
+
+    /** Send the VR thread what has changed about each part
+      * @param changes are the parts changed and what changed about each
+      */
+    void partsChanged(const PartChangeNotifier::Changes& changes);
+
+    /** Remove every actor from the VR scene and forget the parts, called
+      * before the parts are deleted */
+    void clear();
+
+private:
+    /** Give a part a VR actor if it has geometry and does not have one */
+    void addPart(ModelPart* part);
+
+    /** Send the geometry a part now shows */
+    void updateGeometry(ModelPart* part);
+
+    /** Send the visibility of a part and every part below it */
+    void updateVisibility(ModelPart* part);
+
+    /** Send a part's position as its actor's transform */
+    void updatePosition(ModelPart* part);
+
+    VRRenderThread*                                 thread;
+    QHash<ModelPart*, vtkSmartPointer<vtkActor>>    actors;     /**< Each part's VR actor, owned by the VR thread once added */
+};
+
+#endif
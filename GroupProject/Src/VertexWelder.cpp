@@ -0,0 +1,322 @@
+/**     @file VertexWelder.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Merges duplicate triangle corners into shared vertices so that parts
+  *     loaded from STL files use indexed geometry.
+  */
+
+#include "VertexWelder.h"
+
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/* Number of points handled by each thread when computing keys */
+static const vtkIdType grainSize = 65536;
+
+/* Grid cell (or exact coordinate bit pattern) that a point falls into */
+struct GridKey {
+    vtkTypeInt64 x, y, z;
+
+    bool operator==(const GridKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct GridKeyHash {
+    size_t operator()(const GridKey& k) const {
+        uint64_t h = uint64_t(k.x) * 0x9E3779B97F4A7C15ull;
+        h ^= uint64_t(k.y) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        h ^= uint64_t(k.z) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        return size_t(h ^ (h >> 31));
+    }
+};
+
+/* Bit pattern of a coordinate, with -0 and +0 treated as the same value */
+static vtkTypeInt64 exactKey(double v) {
+    if (v == 0.0)
+        return 0;
+    vtkTypeInt64 bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+/* Cells are welded in 27 passes, one per cell class, so that no two cells
+ * welded at the same time are within a cell of each other */
+static int cellClass(const GridKey& k) {
+    auto mod3 = [](vtkTypeInt64 v) { return int(((v % 3) + 3) % 3); };
+    return mod3(k.x) + 3 * mod3(k.y) + 9 * mod3(k.z);
+}
+
+/**
+ * @brief Picks each point's representative so points within tolerance are merged.
+ *
+ * The cells are tolerance sized, so points within tolerance of each other
+ * are in the same or neighbouring cells. Points are welded cell by cell,
+ * each in input order: a point joins the lowest numbered representative
+ * within tolerance in its own or any of the 26 neighbouring cells, or
+ * becomes a representative itself. Cells are taken one class at a time,
+ * and cells in the same class are at least three cells apart, so each
+ * class is welded in parallel without two threads looking at the same
+ * cell. The order is fixed, so the result does not depend on the thread
+ * count, and no two representatives are within tolerance of each other.
+ *
+ * @param points are the points.
+ * @param tolerance is the largest distance at which points are merged.
+ * @param keys are each point's cell.
+ * @param rep holds each point's cell on entry, named after the cell's first point, and its representative on return.
+ * @param findCell gives the first point of the cell with a key, or -1 if the cell is empty.
+ */
+template <typename FindCell>
+static void weldWithinTolerance(vtkPoints* points, double tolerance, const std::vector<GridKey>& keys,
+                                std::vector<vtkIdType>& rep, FindCell findCell) {
+    vtkIdType n = vtkIdType(keys.size());
+
+    /* Number the cells in order of their first points, and list each cell's points in input order */
+    std::vector<vtkIdType> cellIndex(n, -1);
+    std::vector<vtkIdType> firstPoints;
+    for (vtkIdType i = 0; i < n; i++) {
+        if (rep[i] == i) {
+            cellIndex[i] = vtkIdType(firstPoints.size());
+            firstPoints.push_back(i);
+        }
+    }
+    vtkIdType cellCount = vtkIdType(firstPoints.size());
+
+    std::vector<vtkIdType> cellStart(cellCount + 1, 0);
+    for (vtkIdType i = 0; i < n; i++)
+        cellStart[cellIndex[rep[i]] + 1]++;
+    for (vtkIdType c = 0; c < cellCount; c++)
+        cellStart[c + 1] += cellStart[c];
+
+    std::vector<vtkIdType> cellPoints(n);
+    std::vector<vtkIdType> fill(cellStart.begin(), cellStart.end() - 1);
+    for (vtkIdType i = 0; i < n; i++)
+        cellPoints[fill[cellIndex[rep[i]]]++] = i;
+
+    /* Each cell's representatives are kept in the first slots of its own
+     * range of cellPoints' length, only ever written by the cell's thread */
+    std::vector<vtkIdType> reps(n);
+    std::vector<vtkIdType> repCount(cellCount, 0);
+
+    std::vector<vtkIdType> classStart(28, 0);
+    for (vtkIdType c = 0; c < cellCount; c++)
+        classStart[cellClass(keys[firstPoints[c]]) + 1]++;
+    for (int k = 0; k < 27; k++)
+        classStart[k + 1] += classStart[k];
+    std::vector<vtkIdType> byClass(cellCount);
+    std::vector<vtkIdType> classFill(classStart.begin(), classStart.end() - 1);
+    for (vtkIdType c = 0; c < cellCount; c++)
+        byClass[classFill[cellClass(keys[firstPoints[c]])]++] = c;
+
+    const double tolerance2 = tolerance * tolerance;
+    for (int k = 0; k < 27; k++) {
+        vtkSMPTools::For(classStart[k], classStart[k + 1], [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType b = begin; b < end; b++) {
+                vtkIdType c = byClass[b];
+                const GridKey& key = keys[firstPoints[c]];
+
+                vtkIdType neighbours[27];
+                int neighbourCount = 0;
+                for (int dz = -1; dz <= 1; dz++)
+                    for (int dy = -1; dy <= 1; dy++)
+                        for (int dx = -1; dx <= 1; dx++) {
+                            vtkIdType first = findCell({ key.x + dx, key.y + dy, key.z + dz });
+                            if (first >= 0)
+                                neighbours[neighbourCount++] = cellIndex[first];
+                        }
+
+                for (vtkIdType j = cellStart[c]; j < cellStart[c + 1]; j++) {
+                    vtkIdType i = cellPoints[j];
+                    double p[3];
+                    points->GetPoint(i, p);
+
+                    vtkIdType best = -1;
+                    for (int m = 0; m < neighbourCount; m++) {
+                        vtkIdType other = neighbours[m];
+                        for (vtkIdType r = 0; r < repCount[other]; r++) {
+                            vtkIdType candidate = reps[cellStart[other] + r];
+                            if (best >= 0 && candidate > best)
+                                continue;
+                            double q[3];
+                            points->GetPoint(candidate, q);
+                            if (vtkMath::Distance2BetweenPoints(p, q) <= tolerance2)
+                                best = candidate;
+                        }
+                    }
+
+                    if (best < 0) {
+                        best = i;
+                        reps[cellStart[c] + repCount[c]++] = i;
+                    }
+                    rep[i] = best;
+                }
+            }
+        });
+    }
+}
+
+/* Replace each triangle's point ids with the welded ids and flag triangles that are still valid */
+template <typename T>
+static void remapTriangles(const T* conn, vtkIdType triangles, const std::vector<vtkIdType>& newId,
+                           std::vector<vtkTypeInt32>& remapped, std::vector<char>& keep) {
+    vtkSMPTools::For(0, triangles, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++) {
+            vtkTypeInt32 a = vtkTypeInt32(newId[conn[3 * t]]);
+            vtkTypeInt32 b = vtkTypeInt32(newId[conn[3 * t + 1]]);
+            vtkTypeInt32 c = vtkTypeInt32(newId[conn[3 * t + 2]]);
+            remapped[3 * t] = a;
+            remapped[3 * t + 1] = b;
+            remapped[3 * t + 2] = c;
+            keep[t] = (a != b && b != c && a != c);
+        }
+    });
+}
+
+vtkSmartPointer<vtkPolyData> VertexWelder::weld(vtkPolyData* input, double tolerance) {
+    vtkPoints* points = input->GetPoints();
+    vtkCellArray* polys = input->GetPolys();
+    if (points == nullptr || polys == nullptr || polys->IsHomogeneous() != 3
+        || input->GetNumberOfVerts() || input->GetNumberOfLines() || input->GetNumberOfStrips())
+        return input;
+
+    vtkIdType n = points->GetNumberOfPoints();
+    vtkIdType triangles = polys->GetNumberOfCells();
+    if (n == 0 || n > VTK_TYPE_INT32_MAX)
+        return input;
+
+    /* 1. Work out which grid cell each point is in, and which hash bucket that cell belongs to */
+    const vtkIdType buckets = 8 * vtkSMPTools::GetEstimatedNumberOfThreads();
+    std::vector<GridKey> keys(n);
+    std::vector<vtkIdType> bucketOf(n);
+    GridKeyHash hash;
+
+    vtkSMPTools::For(0, n, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        double p[3];
+        for (vtkIdType i = begin; i < end; i++) {
+            points->GetPoint(i, p);
+            if (tolerance > 0.0)
+                keys[i] = { vtkTypeInt64(std::floor(p[0] / tolerance)),
+                            vtkTypeInt64(std::floor(p[1] / tolerance)),
+                            vtkTypeInt64(std::floor(p[2] / tolerance)) };
+            else
+                keys[i] = { exactKey(p[0]), exactKey(p[1]), exactKey(p[2]) };
+            bucketOf[i] = vtkIdType(hash(keys[i]) % size_t(buckets));
+        }
+    });
+
+    /* 2. Group the points by bucket, keeping input order within each bucket */
+    std::vector<vtkIdType> bucketStart(buckets + 1, 0);
+    for (vtkIdType i = 0; i < n; i++)
+        bucketStart[bucketOf[i] + 1]++;
+    for (vtkIdType b = 0; b < buckets; b++)
+        bucketStart[b + 1] += bucketStart[b];
+
+    std::vector<vtkIdType> order(n);
+    std::vector<vtkIdType> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (vtkIdType i = 0; i < n; i++)
+        order[fill[bucketOf[i]]++] = i;
+
+    /* 3. Find each point's cell, bucket by bucket in parallel, a cell can only
+     *    ever be in one bucket. Each cell is named after its first point. */
+    std::vector<vtkIdType> rep(n);
+    std::vector<std::unordered_map<GridKey, vtkIdType, GridKeyHash>> cellsOf(buckets);
+    vtkSMPTools::For(0, buckets, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType b = first; b < last; b++) {
+            std::unordered_map<GridKey, vtkIdType, GridKeyHash>& cells = cellsOf[b];
+            cells.reserve(size_t(bucketStart[b + 1] - bucketStart[b]));
+            for (vtkIdType j = bucketStart[b]; j < bucketStart[b + 1]; j++) {
+                vtkIdType i = order[j];
+                rep[i] = cells.emplace(keys[i], i).first->second;
+            }
+        }
+    });
+
+    /* With no tolerance the cell is the exact coordinates, so its first point
+     * is the representative. Otherwise points within tolerance may be in
+     * neighbouring cells, and points in one cell may be further apart. */
+    if (tolerance > 0.0)
+        weldWithinTolerance(points, tolerance, keys, rep, [&](const GridKey& key) {
+            const std::unordered_map<GridKey, vtkIdType, GridKeyHash>& cells = cellsOf[hash(key) % size_t(buckets)];
+            auto cell = cells.find(key);
+            return cell == cells.end() ? vtkIdType(-1) : cell->second;
+        });
+
+    /* 4. Number the representatives in input order, then every other point
+     *    takes its representative's number */
+    std::vector<vtkIdType> newId(n);
+    vtkIdType unique = 0;
+    for (vtkIdType i = 0; i < n; i++) {
+        if (rep[i] == i)
+            newId[i] = unique++;
+    }
+    vtkSMPTools::For(0, n, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; i++) {
+            if (rep[i] != i)
+                newId[i] = newId[rep[i]];
+        }
+    });
+
+    vtkSmartPointer<vtkPoints> welded = vtkSmartPointer<vtkPoints>::New();
+    welded->SetDataType(points->GetDataType());
+    welded->SetNumberOfPoints(unique);
+    vtkSMPTools::For(0, n, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        double p[3];
+        for (vtkIdType i = begin; i < end; i++) {
+            if (rep[i] == i) {
+                points->GetPoint(i, p);
+                welded->SetPoint(newId[i], p);
+            }
+        }
+    });
+
+    /* 5. Re-index the triangles and drop any that have collapsed */
+    std::vector<vtkTypeInt32> remapped(3 * triangles);
+    std::vector<char> keep(triangles);
+    vtkDataArray* conn = polys->GetConnectivityArray();
+    if (vtkTypeInt32Array* conn32 = vtkTypeInt32Array::SafeDownCast(conn))
+        remapTriangles(conn32->GetPointer(0), triangles, newId, remapped, keep);
+    else if (vtkTypeInt64Array* conn64 = vtkTypeInt64Array::SafeDownCast(conn))
+        remapTriangles(conn64->GetPointer(0), triangles, newId, remapped, keep);
+    else
+        return input;
+
+    vtkSmartPointer<vtkTypeInt32Array> connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(3 * triangles);
+    vtkTypeInt32* out = connectivity->GetPointer(0);
+    vtkIdType kept = 0;
+    for (vtkIdType t = 0; t < triangles; t++) {
+        if (keep[t]) {
+            std::memcpy(out + 3 * kept, remapped.data() + 3 * t, 3 * sizeof(vtkTypeInt32));
+            kept++;
+        }
+    }
+    connectivity->Resize(3 * kept);
+    connectivity->SetNumberOfValues(3 * kept);
+
+    vtkSmartPointer<vtkTypeInt32Array> offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(kept + 1);
+    vtkTypeInt32* offset = offsets->GetPointer(0);
+    vtkSMPTools::For(0, kept + 1, grainSize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType t = begin; t < end; t++)
+            offset[t] = vtkTypeInt32(3 * t);
+    });
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(welded);
+    output->SetPolys(cells);
+    return output;
+}
@@ -0,0 +1,32 @@
+/**     @file VertexWelder.h
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Merges duplicate triangle corners into shared vertices so that parts
+  *     loaded from STL files use indexed geometry.
+  */
+
+#ifndef VIEWER_VERTEXWELDER_H
+#define VIEWER_VERTEXWELDER_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class VertexWelder {
+public:
+    /** Merge points that are within a tolerance of each other.
+      * Points are binned into tolerance-sized grid cells with a spatial hash,
+      * and each point is compared with the points already kept in its own
+      * and the 26 neighbouring cells, so points within tolerance are merged
+      * wherever the cell boundaries fall. Each point joins the lowest
+      * numbered kept point within tolerance, in a fixed order, so the result
+      * does not depend on the number of threads, and no two kept points are
+      * within tolerance. Triangles that collapse to a line or point are removed.
+      * @param input is triangle polydata, e.g. from one of the STL readers
+      * @param tolerance is the largest distance between merged points, 0 merges only identical coordinates
+      * @return the welded geometry, or input unchanged if it holds anything other than triangles
+      */
+    static vtkSmartPointer<vtkPolyData> weld(vtkPolyData* input, double tolerance);
+};
+
+#endif
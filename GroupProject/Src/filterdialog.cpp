@@ -0,0 +1,109 @@
+#include "filterdialog.h"
+#include "ui_filterdialog.h"
+#include <QSettings>
+#include <QSignalBlocker>
+
+/* Number of steps along the clip position slider */
+static const int positionSteps = 1000;
+
+FilterDialog::FilterDialog(QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::FilterDialog)
+{
+    ui->setupUi(this);
+    ui->positionSlider->setRange(0, positionSteps);
+
+    connect(ui->shrinkSlider, &QSlider::valueChanged, this, &FilterDialog::updateShrinkFactor);
+    connect(ui->axisComboBox, &QComboBox::currentIndexChanged, this, &FilterDialog::updateClipPosition);
+    connect(ui->flipCheckBox, &QCheckBox::toggled, this, &FilterDialog::updateClipPlane);
+    connect(ui->positionSlider, &QSlider::valueChanged, this, &FilterDialog::updateClipPosition);
+}
+
+FilterDialog::~FilterDialog()
+{
+    QSettings settings;
+    settings.setValue("filters/shrinkFactor", shrinkFactor());
+    settings.setValue("filters/clipAxis", ui->axisComboBox->currentIndex());
+    settings.setValue("filters/clipFlip", ui->flipCheckBox->isChecked());
+    settings.setValue("filters/clipPosition", clipPosition);
+    delete ui;
+}
+
+void FilterDialog::loadSettings()
+{
+    QSettings settings;
+    const QSignalBlocker shrinkBlocker(ui->shrinkSlider);
+    const QSignalBlocker axisBlocker(ui->axisComboBox);
+    const QSignalBlocker flipBlocker(ui->flipCheckBox);
+
+    ui->shrinkSlider->setValue(int(settings.value("filters/shrinkFactor", 0.5).toDouble() * 100.0 + 0.5));
+    ui->shrinkLabel->setText(QString::number(shrinkFactor(), 'f', 2));
+    ui->axisComboBox->setCurrentIndex(settings.value("filters/clipAxis", 1).toInt());
+    ui->flipCheckBox->setChecked(settings.value("filters/clipFlip", false).toBool());
+    clipPosition = settings.value("filters/clipPosition", 0.0).toDouble();
+    updatePositionSlider();
+}
+
+void FilterDialog::setSceneBounds(const double sceneBounds[6])
+{
+    /* An empty scene has inverted bounds, keep the previous range then */
+    for (int axis = 0; axis < 3; axis++) {
+        if (sceneBounds[2 * axis] > sceneBounds[2 * axis + 1])
+            return;
+    }
+    for (int i = 0; i < 6; i++)
+        bounds[i] = sceneBounds[i];
+    updatePositionSlider();
+}
+
+double FilterDialog::shrinkFactor() const
+{
+    return ui->shrinkSlider->value() / 100.0;
+}
+
+void FilterDialog::clipPlane(double origin[3], double normal[3]) const
+{
+    int axis = ui->axisComboBox->currentIndex();
+    for (int i = 0; i < 3; i++) {
+        origin[i] = 0.0;
+        normal[i] = 0.0;
+    }
+    origin[axis] = clipPosition;
+    normal[axis] = ui->flipCheckBox->isChecked() ? -1.0 : 1.0;
+}
+
+void FilterDialog::updateShrinkFactor()
+{
+    ui->shrinkLabel->setText(QString::number(shrinkFactor(), 'f', 2));
+    emit shrinkFactorChanged(shrinkFactor());
+}
+
+void FilterDialog::updateClipPosition()
+{
+    /* The slider covers the scene along the chosen axis */
+    int axis = ui->axisComboBox->currentIndex();
+    double low = bounds[2 * axis], high = bounds[2 * axis + 1];
+    clipPosition = low + (high - low) * ui->positionSlider->value() / positionSteps;
+    updateClipPlane();
+}
+
+void FilterDialog::updateClipPlane()
+{
+    ui->positionLabel->setText(QString::number(clipPosition, 'g', 4));
+
+    double origin[3], normal[3];
+    clipPlane(origin, normal);
+    emit clipPlaneChanged(origin, normal);
+}
+
+void FilterDialog::updatePositionSlider()
+{
+    int axis = ui->axisComboBox->currentIndex();
+    double low = bounds[2 * axis], high = bounds[2 * axis + 1];
+    double fraction = high > low ? (clipPosition - low) / (high - low) : 0.5;
+    fraction = qBound(0.0, fraction, 1.0);
+
+    const QSignalBlocker blocker(ui->positionSlider);
+    ui->positionSlider->setValue(int(fraction * positionSteps + 0.5));
+    ui->positionLabel->setText(QString::number(clipPosition, 'g', 4));
+}
@@ -0,0 +1,61 @@
+#ifndef FILTERDIALOG_H
+#define FILTERDIALOG_H
+
+#include <QDialog>
+
+namespace Ui {
+class FilterDialog;
+}
+
+/* Non-modal dialog with sliders for the shrink factor and clip plane.
+ * The settings are sent out while the sliders are dragged, so the view
+ * can follow them live. */
+class FilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+
+    explicit FilterDialog(QWidget *parent = nullptr);
+    ~FilterDialog();
+
+    /** Set the range the clip plane can be moved through
+      * @param bounds is the scene's xmin, xmax, ymin, ymax, zmin, zmax
+      */
+    void setSceneBounds(const double bounds[6]);
+
+    /** Get the shrink factor currently set
+      * @return the shrink factor
+      */
+    double shrinkFactor() const;
+
+    /** Get the clip plane currently set
+      * @param origin receives a point on the plane
+      * @param normal receives the normal of the plane
+      */
+    void clipPlane(double origin[3], double normal[3]) const;
+
+    /** Restore the last settings used */
+    void loadSettings();
+
+signals:
+
+    void shrinkFactorChanged(double factor);
+    void clipPlaneChanged(const double origin[3], const double normal[3]);
+
+private slots:
+
+    void updateShrinkFactor();
+    void updateClipPosition();
+    void updateClipPlane();
+
+private:
+    /** Move the position slider to match clipPosition without sending a change */
+    void updatePositionSlider();
+
+    Ui::FilterDialog *ui;
+    double bounds[6] = { -1.0, 1.0, -1.0, 1.0, -1.0, 1.0 };
+    double clipPosition = 0.0;      /**< Where the plane crosses its axis */
+};
+
+#endif // FILTERDIALOG_H
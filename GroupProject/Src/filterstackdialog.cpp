@@ -0,0 +1,244 @@
+#include "filterstackdialog.h"
+#include "ui_filterstackdialog.h"
+#include "ModelPart.h"
+#include "FilterStages.h"
+#include <QSignalBlocker>
+
+/* Columns of the stage table */
+enum { FilterColumn, TimeColumn, CellsColumn };
+
+FilterStackDialog::FilterStackDialog(QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::FilterStackDialog)
+{
+    ui->setupUi(this);
+    ui->typeComboBox->addItems(FilterStages::names());
+
+    connect(ui->addButton, &QPushButton::clicked, this, &FilterStackDialog::addStage);
+    connect(ui->removeButton, &QPushButton::clicked, this, &FilterStackDialog::removeStage);
+    connect(ui->upButton, &QPushButton::clicked, this, &FilterStackDialog::moveStageUp);
+    connect(ui->downButton, &QPushButton::clicked, this, &FilterStackDialog::moveStageDown);
+    connect(ui->applySubtreeButton, &QPushButton::clicked, this, &FilterStackDialog::applyToSubtree);
+    connect(ui->stageTable, &QTableWidget::itemChanged, this, &FilterStackDialog::stageItemChanged);
+    connect(ui->stageTable, &QTableWidget::itemSelectionChanged, this, &FilterStackDialog::fillParameters);
+    connect(ui->parameterTable, &QTableWidget::itemChanged, this, &FilterStackDialog::parameterItemChanged);
+
+    setPart(nullptr);
+}
+
+FilterStackDialog::~FilterStackDialog()
+{
+    delete ui;
+}
+
+void FilterStackDialog::setPart(ModelPart* part)
+{
+    editedPart = part;
+    ui->partLabel->setText(part ? part->getName() : tr("No part selected"));
+    ui->addButton->setEnabled(part != nullptr);
+    ui->applySubtreeButton->setEnabled(part != nullptr);
+    fillStages();
+}
+
+ModelPart* FilterStackDialog::part() const
+{
+    return editedPart;
+}
+
+void FilterStackDialog::fillStages()
+{
+    int selected = currentStage();
+
+    {
+        const QSignalBlocker blocker(ui->stageTable);
+        FilterPipeline* filters = editedPart ? editedPart->getFilters() : nullptr;
+        int count = filters ? filters->stageCount() : 0;
+
+        ui->stageTable->setRowCount(count);
+        for (int i = 0; i < count; i++) {
+            FilterStage* stage = filters->stage(i);
+            QTableWidgetItem* item = new QTableWidgetItem(stage->name());
+            item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+            item->setCheckState(stage->isEnabled() ? Qt::Checked : Qt::Unchecked);
+            ui->stageTable->setItem(i, FilterColumn, item);
+
+            for (int column : { TimeColumn, CellsColumn }) {
+                QTableWidgetItem* value = new QTableWidgetItem;
+                value->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+                value->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                ui->stageTable->setItem(i, column, value);
+            }
+        }
+
+        if (count > 0)
+            ui->stageTable->selectRow(qBound(0, selected, count - 1));
+    }
+
+    refreshTimings();
+
+    /* Leave a parameter being typed in alone */
+    if (ui->parameterTable->state() != QAbstractItemView::EditingState)
+        fillParameters();
+}
+
+void FilterStackDialog::refresh()
+{
+    fillStages();
+}
+
+void FilterStackDialog::refreshTimings()
+{
+    if (editedPart == nullptr) {
+        ui->totalLabel->clear();
+        return;
+    }
+
+    FilterPipeline* filters = editedPart->getFilters();
+    double total = 0.0;
+    for (int i = 0; i < filters->stageCount() && i < ui->stageTable->rowCount(); i++) {
+        FilterStage* stage = filters->stage(i);
+
+        /* Disabled stages and stages that have not run yet have nothing to show */
+        bool hasRun = stage->isEnabled() && stage->getRunTime() >= 0.0;
+        ui->stageTable->item(i, TimeColumn)->setText(hasRun ? QString::number(stage->getRunTime(), 'f', 1) : QString("-"));
+        ui->stageTable->item(i, CellsColumn)->setText(hasRun ? QString::number(stage->getOutputCellCount()) : QString("-"));
+        if (hasRun)
+            total += stage->getRunTime();
+    }
+
+    vtkPolyData* input = filters->getInput();
+    ui->totalLabel->setText(tr("Input: %1 cells, last run of enabled stages: %2 ms")
+        .arg(input ? QString::number(input->GetNumberOfCells()) : QString("-"))
+        .arg(total, 0, 'f', 1));
+}
+
+void FilterStackDialog::fillParameters()
+{
+    const QSignalBlocker blocker(ui->parameterTable);
+    int index = currentStage();
+    ui->removeButton->setEnabled(index >= 0);
+    ui->upButton->setEnabled(index > 0);
+    ui->downButton->setEnabled(index >= 0 && index + 1 < ui->stageTable->rowCount());
+
+    if (index < 0) {
+        ui->parameterTable->setRowCount(0);
+        return;
+    }
+
+    FilterStage* stage = editedPart->getFilters()->stage(index);
+    ui->parameterTable->setRowCount(stage->parameterCount());
+    for (int p = 0; p < stage->parameterCount(); p++) {
+        double minimum, maximum;
+        stage->parameterRange(p, minimum, maximum);
+
+        QTableWidgetItem* name = new QTableWidgetItem(stage->parameterName(p));
+        name->setFlags(Qt::ItemIsEnabled);
+        name->setToolTip(tr("From %1 to %2").arg(minimum).arg(maximum));
+        ui->parameterTable->setItem(p, 0, name);
+        ui->parameterTable->setItem(p, 1, new QTableWidgetItem(QString::number(stage->parameter(p), 'g', 6)));
+    }
+}
+
+int FilterStackDialog::currentStage() const
+{
+    if (editedPart == nullptr)
+        return -1;
+
+    QList<QTableWidgetItem*> selected = ui->stageTable->selectedItems();
+    if (selected.isEmpty())
+        return -1;
+
+    int row = selected.first()->row();
+    return row < editedPart->getFilters()->stageCount() ? row : -1;
+}
+
+void FilterStackDialog::addStage()
+{
+    if (editedPart == nullptr)
+        return;
+
+    /* New stages go after the selected one, or at the end */
+    FilterStage* stage = ModelPart::createFilterStage(ui->typeComboBox->currentText());
+    stage->setEnabled(true);
+    int index = currentStage() >= 0 ? currentStage() + 1 : editedPart->getFilters()->stageCount();
+    editedPart->getFilters()->insertStage(index, stage);
+
+    fillStages();
+    ui->stageTable->selectRow(index);
+    emit stackChanged(editedPart);
+}
+
+void FilterStackDialog::removeStage()
+{
+    int index = currentStage();
+    if (index < 0)
+        return;
+
+    editedPart->getFilters()->removeStage(index);
+    fillStages();
+    emit stackChanged(editedPart);
+}
+
+void FilterStackDialog::moveStageUp()
+{
+    moveStage(-1);
+}
+
+void FilterStackDialog::moveStageDown()
+{
+    moveStage(1);
+}
+
+void FilterStackDialog::moveStage(int offset)
+{
+    int index = currentStage();
+    int target = index + offset;
+    if (index < 0 || target < 0 || target >= editedPart->getFilters()->stageCount())
+        return;
+
+    editedPart->getFilters()->moveStage(index, target);
+    fillStages();
+    ui->stageTable->selectRow(target);
+    emit stackChanged(editedPart);
+}
+
+void FilterStackDialog::applyToSubtree()
+{
+    if (editedPart == nullptr)
+        return;
+
+    editedPart->setFilterStack(editedPart->getFilters());
+    emit stackApplied(editedPart);
+}
+
+void FilterStackDialog::stageItemChanged(QTableWidgetItem* item)
+{
+    if (editedPart == nullptr || item->column() != FilterColumn)
+        return;
+
+    editedPart->getFilters()->stage(item->row())->setEnabled(item->checkState() == Qt::Checked);
+    refreshTimings();
+    emit stackChanged(editedPart);
+}
+
+void FilterStackDialog::parameterItemChanged(QTableWidgetItem* item)
+{
+    int index = currentStage();
+    if (index < 0 || item->column() != 1)
+        return;
+
+    FilterStage* stage = editedPart->getFilters()->stage(index);
+    bool ok = false;
+    double value = item->text().toDouble(&ok);
+    if (ok)
+        stage->setParameter(item->row(), value);
+
+    /* Show the value actually used, after clamping or a bad entry */
+    {
+        const QSignalBlocker blocker(ui->parameterTable);
+        item->setText(QString::number(stage->parameter(item->row()), 'g', 6));
+    }
+
+    if (ok)
+        emit stackChanged(editedPart);
+}
@@ -0,0 +1,80 @@
+#ifndef FILTERSTACKDIALOG_H
+#define FILTERSTACKDIALOG_H
+
+#include <QDialog>
+
+class ModelPart;
+class QTableWidgetItem;
+
+namespace Ui {
+class FilterStackDialog;
+}
+
+/* Non-modal editor for the ordered filter stack of one part. Stages can be
+ * added, removed, reordered, switched on and off and their parameters
+ * changed, and the stack copied to every part below. The time each stage
+ * took and the number of cells it made are shown next to it. */
+class FilterStackDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+
+    explicit FilterStackDialog(QWidget *parent = nullptr);
+    ~FilterStackDialog();
+
+    /** Show a part's filter stack for editing
+      * @param part is the part, nullptr to show nothing, e.g. before the tree is replaced
+      */
+    void setPart(ModelPart* part);
+
+    /** Get the part being edited
+      * @return the part, nullptr if none
+      */
+    ModelPart* part() const;
+
+public slots:
+
+    /** Show the part's stack again, e.g. once its filters have run or its
+      * parameters were changed elsewhere */
+    void refresh();
+
+signals:
+
+    /** The part's stack was changed and needs running again */
+    void stackChanged(ModelPart* part);
+
+    /** The part's stack was copied to every part below it */
+    void stackApplied(ModelPart* part);
+
+private slots:
+
+    void addStage();
+    void removeStage();
+    void moveStageUp();
+    void moveStageDown();
+    void applyToSubtree();
+    void stageItemChanged(QTableWidgetItem* item);
+    void parameterItemChanged(QTableWidgetItem* item);
+    void fillParameters();
+
+private:
+    /** Rebuild the stage table from the part's stack */
+    void fillStages();
+
+    /** Update the run time and cell count shown for each stage */
+    void refreshTimings();
+
+    /** Move the selected stage up or down the stack */
+    void moveStage(int offset);
+
+    /** Get the row of the selected stage
+      * @return the stage index, -1 if none is selected
+      */
+    int currentStage() const;
+
+    Ui::FilterStackDialog *ui;
+    ModelPart* editedPart = nullptr;
+};
+
+#endif // FILTERSTACKDIALOG_H
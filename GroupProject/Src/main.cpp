@@ -1,10 +1,20 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QSettings>
+#include <vtkSMPTools.h>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    a.setOrganizationName("University of Nottingham");
+    a.setApplicationName("BaseProject");
+
+    /* Filter kernels use every core unless a thread count is set, e.g. to
+     * compare stage timings at different thread counts */
+    QSettings settings;
+    vtkSMPTools::Initialize(settings.value("filters/threads", 0).toInt());
+
     MainWindow w;
     w.show();
     return a.exec();
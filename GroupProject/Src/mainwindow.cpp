@@ -5,6 +5,8 @@
 #include <QFileDialog>
 #include "ModelPart.h"
 #include "optiondialog.h"
+#include "GeometryCache.h"
+#include "ProjectFile.h"
 #include <QDebug>
 #include <vtkCylinderSource.h>
 #include <vtkPolyDataMapper.h>
@@ -14,6 +16,10 @@
 #include <QPixMap>
 #include <qmessagebox.h>
 #include <vtkLight.h>
+#include <QSettings>
+#include <QTimer>
+#include <QInputDialog>
+#include <QSignalBlocker>
 // Other includes come after
 
 /**
@@ -39,6 +45,78 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->pushButton_4, &QPushButton::released, this, &MainWindow::on_pushButton_4_clicked);
     connect(ui->treeView, &QTreeView::clicked, this, &MainWindow::handleTreeClicked);
     connect(this, &MainWindow::statusUpdateMessage, ui->statusbar, &QStatusBar::showMessage);
+
+    /* Background STL loading, with progress and a cancel button in the status bar */
+    loader = new STLLoader(this);
+    loadProgress = new QProgressBar(this);
+    loadProgress->setMaximumWidth(200);
+    loadProgress->hide();
+    cancelLoadButton = new QPushButton(tr("Cancel"), this);
+    cancelLoadButton->hide();
+    ui->statusbar->addPermanentWidget(loadProgress);
+    ui->statusbar->addPermanentWidget(cancelLoadButton);
+    connect(loader, &STLLoader::progress, this, &MainWindow::updateLoadProgress);
+    connect(loader, &STLLoader::finished, this, &MainWindow::loadFinished);
+    connect(cancelLoadButton, &QPushButton::released, this, &MainWindow::cancelLoading);
+
+    /* Filters run in the background too, one task per part */
+    filterRunner = new FilterRunner(this);
+    connect(filterRunner, &FilterRunner::progress, this, [this](int done, int total) {
+        emit statusUpdateMessage(QString("Applying filters: %1 of %2 parts").arg(done).arg(total), 0);
+    });
+    connect(filterRunner, &FilterRunner::finished, this, [this]() {
+        emit statusUpdateMessage(QString("Filters applied"), 2000);
+    });
+
+    /* The filter settings dialog stays around so its sliders keep their place */
+    filterDialog = new FilterDialog(this);
+    filterDialog->loadSettings();
+    connect(filterDialog, &FilterDialog::shrinkFactorChanged, this, &MainWindow::setShrinkFactor);
+    connect(filterDialog, &FilterDialog::clipPlaneChanged, this, &MainWindow::setClipPlane);
+
+    /* The filter stack editor follows the tree selection and shows stage
+     * timings as the runs finish */
+    filterStackDialog = new FilterStackDialog(this);
+    connect(filterRunner, &FilterRunner::finished, filterStackDialog, &FilterStackDialog::refresh);
+    connect(filterStackDialog, &FilterStackDialog::stackChanged, this, [this](ModelPart* part) {
+        filterPart(part);
+        showPartChange(part);
+    });
+    connect(filterStackDialog, &FilterStackDialog::stackApplied, this, [this](ModelPart* part) {
+        filterSubtree(part);
+        showSubtreeChange(part);
+    });
+
+    /* Reload parts whose STL file is changed on disk. Exporters often write a
+     * file in several steps, so changes are collected for a moment first. */
+    fileWatcher = new QFileSystemWatcher(this);
+    reloadTimer = new QTimer(this);
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(500);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::fileChanged);
+    connect(reloadTimer, &QTimer::timeout, this, &MainWindow::reloadChangedFiles);
+
+    QSettings settings;
+    ModelPart::setWeldTolerance(settings.value("import/weldTolerance", 0.0).toDouble());
+    GeometryCache::setMaxSize(settings.value("cache/maxSizeMB", 4096).toLongLong() * 1024 * 1024);
+    ui->actionUse_Geometry_Cache->setChecked(settings.value("cache/enabled", true).toBool());
+    GeometryCache::setEnabled(ui->actionUse_Geometry_Cache->isChecked());
+    ui->actionProgressive_Loading->setChecked(settings.value("import/progressive", true).toBool());
+    {
+        /* The tree does not exist yet, only the default for new parts is needed */
+        const QSignalBlocker blocker(ui->actionCap_Clipped_Sections);
+        ui->actionCap_Clipped_Sections->setChecked(settings.value("filters/capClip", false).toBool());
+    }
+    ModelPart::setDefaultClipCapping(ui->actionCap_Clipped_Sections->isChecked());
+    double clipOrigin[3], clipNormal[3];
+    filterDialog->clipPlane(clipOrigin, clipNormal);
+    ModelPart::setDefaultClipPlane(clipOrigin, clipNormal);
+    ModelPart::setDefaultShrinkFactor(filterDialog->shrinkFactor());
+
+    /* Section views cut parts open at render time, at the same plane as the clip filter */
+    sectionPlane = vtkSmartPointer<vtkPlane>::New();
+    sectionPlane->SetOrigin(clipOrigin);
+    sectionPlane->SetNormal(clipNormal);
     
     
 
@@ -86,6 +164,19 @@ MainWindow::MainWindow(QWidget *parent)
     renderer->SetBackground(colors->GetColor3d("white").GetData()); // Set background color to white
     renderWindow->AddRenderer(renderer);
 
+    /* Parts are added to the renderer as they change, see partsChanged() */
+    sceneSync = new SceneSync(renderer);
+    connect(PartChangeNotifier::instance(), &PartChangeNotifier::partsChanged, this, &MainWindow::partsChanged);
+
+    /* Levels of detail are made as geometry arrives and picked as each frame starts */
+    lodManager = new LODManager(renderer, this);
+    lodManager->setTargetFrameRate(settings.value("render/targetFps", 60.0).toDouble());
+    {
+        const QSignalBlocker blocker(ui->actionLevel_of_Detail);
+        ui->actionLevel_of_Detail->setChecked(settings.value("render/levelOfDetail", true).toBool());
+    }
+    lodManager->setEnabled(ui->actionLevel_of_Detail->isChecked());
+
     /* Add a light */
     vtkSmartPointer<vtkLight> light = vtkSmartPointer<vtkLight>::New();
     light->SetLightTypeToSceneLight();
@@ -100,6 +191,11 @@ MainWindow::MainWindow(QWidget *parent)
  */
 MainWindow::~MainWindow()
 {
+    GeometryCache::flush();
+
+    /* Before the renderer and the parts go, it observes one and uses the other */
+    delete lodManager;
+    delete sceneSync;
     delete ui;
 }
 
@@ -141,15 +237,25 @@ void MainWindow::on_pushButton_2_clicked()
     if (selectedPart) {
         // Reset the position of the selected part to its original position
         selectedPart->resetToOriginalPosition();
-        updateRender(); // Update the render window to reflect the changes
-        resetCamera(); // Reset the camera
+        resetCamera(); // Reset the camera, this also shows the change
     }
 }
 /**
  * @brief Handles the second button click event.
  */
 void MainWindow::on_pushButton_3_clicked(){
-    vrThread = new VRRenderThread();
+    if (vrThread && vrThread->isRunning())
+        return;
+
+    /* A session the headset ended by itself leaves its thread behind */
+    delete vrSync;
+    delete vrThread;
+    /* "offscreen" runs VR without a headset, e.g. to time it in CI */
+    QSettings settings;
+    QString backend = qEnvironmentVariable("VIEWER_VR_BACKEND", settings.value("vr/backend", "openvr").toString());
+    int frameLimit = qEnvironmentVariableIntValue("VIEWER_VR_FRAMES");
+    vrThread = new VRRenderThread(nullptr, VRBackend::create(backend, frameLimit));
+    vrSync = new VRSceneSync(vrThread);
     startVR();
 }
 
@@ -167,6 +273,8 @@ void MainWindow::handleTreeClicked(){
     QString text = selectedPart->data(0).toString();
 
     emit statusUpdateMessage(QString("The selected item is: ") + text, 0);
+
+    filterStackDialog->setPart(selectedPart);
 }
 
 
@@ -190,94 +298,538 @@ void MainWindow::on_actionOpen_File_triggered(){
             loadStlFile(path);
         }
     }
-    updateRender();
 }
 
+/**
+ * @brief Queues an STL file to be read in the background.
+ *
+ * The new part is added under the item that was selected when the file was
+ * opened. With progressive loading the part is added straight away and shows
+ * a coarse sample of its triangles until the full geometry is ready,
+ * otherwise it is added and rendered once its geometry is ready. Either way
+ * the view is fitted once, when every file opened together has loaded.
+ *
+ * @param fileName The STL file to load.
+ */
 void MainWindow::loadStlFile(const QString& fileName)
 {
-    emit statusUpdateMessage(QString("The selected file is: ") + fileName, 0);
+    emit statusUpdateMessage(QString("Loading file: ") + fileName, 0);
+    fitCameraOnLoad = true;
 
-    // Use the fileName to open a new child item in the tree
-    QModelIndex index = ui->treeView->currentIndex();
-    ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
-    ModelPart* newItem = new ModelPart({ fileName, selectedPart->getVisibility() });
-    newItem->setName(fileName);
-    selectedPart->appendChild(newItem);
+    QPersistentModelIndex parent = ui->treeView->currentIndex();
+    if (!parent.isValid())
+        parent = partList->index(0, 0, QModelIndex());
 
-    // Call the loadSTL() function of the newly created item to ask it to load from the STL file.
-    newItem->loadSTL(fileName);
-    resetCamera();
-    updateRender();
+    ModelPart* parentPart = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : partList->getRootItem();
+
+    if (ui->actionProgressive_Loading->isChecked()) {
+        ModelPart* newItem = new ModelPart({ fileName, parentPart->getVisibility() });
+        newItem->setName(fileName);
+        newItem->setFileName(fileName);
+        partList->appendPart(parent, newItem);
+        loadPartGeometry(newItem, true);
+        return;
+    }
+
+    loader->load(fileName, [this, fileName, parent](vtkSmartPointer<vtkPolyData> data) {
+        if (data == nullptr) {
+            emit statusUpdateMessage(QString("Failed to load STL file: ") + fileName, 0);
+            return;
+        }
+
+        ModelPart* parentPart = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : partList->getRootItem();
+        ModelPart* newItem = new ModelPart({ fileName, parentPart->getVisibility() });
+        newItem->setName(fileName);
+        newItem->setFileName(fileName);
+        newItem->setGeometry(data);
+        partList->appendPart(parent, newItem);
+        watchFile(fileName);
+    });
 }
 
-void MainWindow::update_name()
+/**
+ * @brief Queues the geometry of a part that is already in the tree.
+ *
+ * The part keeps its proxy until the geometry is ready. The swap only
+ * re-renders, the camera is left where the user put it. The part shows as
+ * loading in the tree until then, and as not loaded if the file cannot be
+ * read or the load is cancelled.
+ *
+ * @param part The part to load, its file name must be set.
+ * @param withProxy True to also queue a coarse proxy ahead of the full load.
+ */
+void MainWindow::loadPartGeometry(ModelPart* part, bool withProxy)
 {
-	QModelIndex index = ui->treeView->currentIndex();
-	ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
-	selectedPart->set(0, selectedPart->getName());
-	updateRender();
+    QString fileName = part->getFileName();
+    part->setLoadState(ModelPart::Loading);
+
+    if (withProxy) {
+        loader->loadProxy(fileName, [this, part](vtkSmartPointer<vtkPolyData> data) {
+            if (data == nullptr)
+                return;
+            part->setProxy(data);
+        });
+    }
+
+    loader->load(fileName, [this, part, fileName](vtkSmartPointer<vtkPolyData> data) {
+        if (data == nullptr) {
+            part->setLoadState(ModelPart::NotLoaded);
+            emit statusUpdateMessage(QString("Failed to load STL file: ") + fileName, 0);
+            return;
+        }
+
+        part->setGeometry(data);
+        watchFile(fileName);
+        filterPart(part);
+    });
 }
 
 /**
- * @brief Updates the render window.
+ * @brief Shows a change made to a part without going through its setters.
+ *
+ * Changes made through ModelPart setters are picked up by partsChanged(),
+ * this is for edits made to a part's filter stages directly. Only this part
+ * is brought up to date, once control returns to the event loop.
+ *
+ * @param part The part that has changed.
  */
-void MainWindow::updateRender()
+void MainWindow::showPartChange(ModelPart* part)
 {
-    renderer->RemoveAllViewProps();
-    updateRenderFromTree(partList->index(0, 0, QModelIndex())); // Ask about this function and index as well
-    renderer->Render();
-    renderWindow->Render();
+    sceneSync->partChanged(part);
+    requestRender();
 }
 
+/**
+ * @brief Brings a part's filtered geometry up to date in the background.
+ *
+ * The part keeps showing its current geometry until the result is ready.
+ * Parts without geometry are skipped, their filters run once it arrives.
+ *
+ * @param part The part to filter.
+ */
+void MainWindow::filterPart(ModelPart* part, bool interactive)
+{
+    if (part->getGeometry() == nullptr)
+        return;
+
+    filterRunner->run(part->getFilters(), [part](vtkSmartPointer<vtkPolyData> data) {
+        part->showFiltered(data);
+    }, interactive);
+}
 
 /**
- * @brief Updates the render window from the model tree.
- * @param index The index of the model tree.
+ * @brief Filters a part and everything below it, one background task per part.
+ * @param part The root of the subtree.
+ * @param interactive True if this is one of a quick series of changes, e.g. from a slider.
  */
-void MainWindow::updateRenderFromTree(const QModelIndex& index)
+void MainWindow::filterSubtree(ModelPart* part, bool interactive)
 {
-    if (index.isValid()) {
-        ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
-        selectedPart->set(1, "true");
+    filterPart(part, interactive);
+    for (int i = 0; i < part->childCount(); i++)
+        filterSubtree(part->child(i), interactive);
+}
 
-        // Check if the ModelPart is visible
-        if (!selectedPart->getVisibility()) {
-            selectedPart->set(1, "false"); // Assuming there is a set() method in ModelPart class
-            return;
+/**
+ * @brief Applies a new shrink factor to every part while its slider moves.
+ *
+ * Only the shrink stage and the stages after it run again, and parts
+ * that are not shrunk have nothing to do.
+ *
+ * @param factor The new shrink factor.
+ */
+void MainWindow::setShrinkFactor(double factor)
+{
+    ModelPart::setDefaultShrinkFactor(factor);
+    partList->getRootItem()->setShrinkFactor(factor);
+    filterSubtree(partList->getRootItem(), true);
+}
+
+/**
+ * @brief Applies a new clip plane to every part while its controls move.
+ *
+ * Shrunk parts keep their cached shrink result, only the clip runs again.
+ *
+ * @param origin A point on the plane.
+ * @param normal Points towards the side that is kept.
+ */
+void MainWindow::setClipPlane(const double origin[3], const double normal[3])
+{
+    ModelPart::setDefaultClipPlane(origin, normal);
+    partList->getRootItem()->setClipPlane(origin, normal);
+    filterSubtree(partList->getRootItem(), true);
+
+    /* Sectioned parts follow straight away, their mappers clip while rendering.
+     * The parts are told too, so VR's copies of the plane follow as well. */
+    sectionPlane->SetOrigin(origin[0], origin[1], origin[2]);
+    sectionPlane->SetNormal(normal[0], normal[1], normal[2]);
+    ModelPart::sectionPlaneMoved(sectionPlane);
+    requestRender();
+}
+
+/**
+ * @brief Re-renders once control returns to the event loop.
+ *
+ * Several parts finishing loading at the same time then cost a single render.
+ */
+void MainWindow::requestRender()
+{
+    if (renderPending)
+        return;
+
+    renderPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        renderPending = false;
+        PartChangeNotifier::instance()->flush();
+        sceneSync->sync();
+        renderWindow->Render();
+    });
+}
+
+/* Add the parts below part that are loaded from fileName to parts */
+static void collectPartsForFile(ModelPart* part, const QString& fileName, QList<ModelPart*>& parts)
+{
+    if (part->getFileName() == fileName)
+        parts.append(part);
+
+    for (int i = 0; i < part->childCount(); i++)
+        collectPartsForFile(part->child(i), fileName, parts);
+}
+
+/**
+ * @brief Starts watching a part's STL file for changes.
+ * @param fileName The STL file.
+ */
+void MainWindow::watchFile(const QString& fileName)
+{
+    if (!fileWatcher->files().contains(fileName))
+        fileWatcher->addPath(fileName);
+}
+
+/**
+ * @brief Notes that a watched STL file has changed on disk.
+ *
+ * The reload waits until the file has stopped changing for a moment.
+ *
+ * @param fileName The changed file.
+ */
+void MainWindow::fileChanged(const QString& fileName)
+{
+    changedFiles.insert(fileName);
+    reloadTimer->start();
+}
+
+/**
+ * @brief Reloads the parts whose STL files have changed.
+ *
+ * Each changed file is parsed once in the background, however many parts
+ * use it. The parts are looked up again when the geometry arrives, so parts
+ * removed in the meantime are skipped, and the new geometry is swapped in
+ * with setGeometry(), which keeps colour, visibility, filters and position.
+ * A file that was only touched hashes the same as before, so the registry
+ * returns the geometry already in use and nothing is swapped.
+ */
+void MainWindow::reloadChangedFiles()
+{
+    QSet<QString> files;
+    files.swap(changedFiles);
+
+    for (const QString& fileName : files) {
+        QList<ModelPart*> parts;
+        collectPartsForFile(partList->getRootItem(), fileName, parts);
+        if (parts.isEmpty()) {
+            fileWatcher->removePath(fileName);
+            continue;
         }
-        
-        vtkActor* actor = selectedPart->getActor(); // Assuming there is a getActor() method in ModelPart class
 
-        // Check if the actor is not null
-        if (actor == nullptr) {
-            qDebug() << "Failed to get actor from model part";
-            return;
+        /* Saving by replacing the file drops it from the watcher. A file that
+         * is still missing has been deleted, and the parts keep their geometry. */
+        if (!QFileInfo::exists(fileName)) {
+            emit statusUpdateMessage(QString("STL file was removed: ") + fileName, 0);
+            continue;
         }
+        watchFile(fileName);
+
+        emit statusUpdateMessage(QString("Reloading changed file: ") + fileName, 0);
+        loader->load(fileName, [this, fileName](vtkSmartPointer<vtkPolyData> data) {
+            if (data == nullptr) {
+                emit statusUpdateMessage(QString("Failed to reload STL file: ") + fileName, 0);
+                return;
+            }
 
-        // Get the color from the ModelPart and set it to the actor
-        QColor color = selectedPart->getColor(); // Assuming there is a get_Color() method in ModelPart class
-        actor->GetProperty()->SetColor(color.redF(), color.greenF(), color.blueF());
+            QList<ModelPart*> parts;
+            collectPartsForFile(partList->getRootItem(), fileName, parts);
+            for (ModelPart* part : parts) {
+                if (part->getGeometry() == data.Get())
+                    continue;
+                part->setGeometry(data);
+                filterPart(part);
+            }
+        });
+    }
+}
+
+/* Build a group part for a folder, with a child group for each sub-folder that
+ * contains STL files and a leaf for each STL file. Leaves are added to files. */
+static ModelPart* buildFolderPart(const QDir& dir, QList<ModelPart*>& files)
+{
+    ModelPart* group = new ModelPart({ dir.dirName(), "true" });
+    group->setName(dir.dirName());
+    group->setTopLevelBool(true);
+
+    for (const QFileInfo& info : dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDir::Name)) {
+        ModelPart* child = buildFolderPart(QDir(info.absoluteFilePath()), files);
+        if (child->childCount() > 0)
+            group->appendChild(child);
+        else
+            delete child;
+    }
 
-        renderer->AddActor(actor);
+    for (const QFileInfo& info : dir.entryInfoList({ "*.stl" }, QDir::Files, QDir::Name)) {
+        ModelPart* leaf = new ModelPart({ info.fileName(), "true" });
+        leaf->setName(info.fileName());
+        leaf->setFileName(info.absoluteFilePath());
+        group->appendChild(leaf);
+        files.append(leaf);
     }
 
-    // Check to see if this part has any children
-    if (!partList->hasChildren(index) || (index.flags() & Qt::ItemNeverHasChildren)) {
+    return group;
+}
+
+/**
+ * @brief Handles the "Import Folder" action trigger.
+ *
+ * Walks the folder recursively, mirroring its sub-folders as group items,
+ * adds the whole branch to the tree in one go and loads every STL file in
+ * parallel.
+ */
+void MainWindow::on_actionImport_Folder_triggered()
+{
+    QString folder = QFileDialog::getExistingDirectory(this, tr("Import Folder"), QDir::currentPath());
+    if (folder.isEmpty())
+        return;
+
+    QList<ModelPart*> files;
+    ModelPart* group = buildFolderPart(QDir(folder), files);
+    if (files.isEmpty()) {
+        delete group;
+        emit statusUpdateMessage(QString("No STL files found in: ") + folder, 0);
         return;
     }
 
-    // Loop through children and add their actors
-    int rows = partList->rowCount(index);
-    for (int i = 0; i < rows; i++) {
-        updateRenderFromTree(partList->index(i, 0, index));
+    partList->appendParts(ui->treeView->currentIndex(), { group });
+    fitCameraOnLoad = true;
+
+    for (ModelPart* part : files)
+        loadPartGeometry(part, ui->actionProgressive_Loading->isChecked());
+
+    emit statusUpdateMessage(QString("Importing %1 files from: ").arg(files.size()) + folder, 0);
+}
+
+/* Collect the parts below (and including) part that have a file to load,
+ * split by whether they will be visible in the render */
+static void collectFileParts(ModelPart* part, bool parentVisible, QList<ModelPart*>& visible, QList<ModelPart*>& hidden)
+{
+    bool isVisible = parentVisible && part->getVisibility();
+
+    if (!part->getFileName().isEmpty())
+        (isVisible ? visible : hidden).append(part);
+
+    for (int i = 0; i < part->childCount(); i++)
+        collectFileParts(part->child(i), isVisible, visible, hidden);
+}
+
+/**
+ * @brief Handles the "Open Project" action trigger.
+ *
+ * The tree and bounding boxes are shown straight away, geometry is loaded
+ * in the background with visible parts first.
+ */
+void MainWindow::on_actionOpen_Project_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open Project"),
+        QDir::currentPath(), tr("Viewer Projects (*.evproj)"));
+    if (fileName.isEmpty())
+        return;
+
+    QList<ModelPart*> parts;
+    if (!ProjectFile::load(fileName, parts)) {
+        qDeleteAll(parts);
+        QMessageBox::warning(this, tr("Open Project"), tr("Could not read project file %1").arg(fileName));
+        return;
     }
-    resetCamera();
+
+    /* Outstanding loads and filters refer to parts of the old tree */
+    loader->cancel();
+    filterRunner->cancel();
+    filterStackDialog->setPart(nullptr);
+    sceneSync->clear();
+    lodManager->clear();
+    if (vrSync != nullptr)
+        vrSync->clear();
+    partList->setParts(parts);
+    fitCameraOnLoad = true;
+
+    QList<ModelPart*> visible, hidden;
+    for (ModelPart* part : parts)
+        collectFileParts(part, true, visible, hidden);
+    for (ModelPart* part : visible + hidden)
+        loadPartGeometry(part, false);
+
+    emit statusUpdateMessage(QString("Opened project: ") + fileName, 0);
+}
+
+/**
+ * @brief Loads the parts whose geometry was cancelled or could not be read.
+ *
+ * Visible parts are queued first, as when a project is opened.
+ */
+void MainWindow::on_actionLoad_Missing_Parts_triggered()
+{
+    QList<ModelPart*> visible, hidden;
+    collectFileParts(partList->getRootItem(), true, visible, hidden);
+
+    int count = 0;
+    for (ModelPart* part : visible + hidden) {
+        if (part->getLoadState() != ModelPart::NotLoaded)
+            continue;
+        loadPartGeometry(part, false);
+        count++;
+    }
+
+    emit statusUpdateMessage(count == 0 ? QString("No parts are missing their geometry")
+                                        : QString("Loading %1 missing parts").arg(count), 0);
+}
+
+/**
+ * @brief Handles the "Save Project" action trigger.
+ */
+void MainWindow::on_actionSave_Project_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Project"),
+        QDir::currentPath(), tr("Viewer Projects (*.evproj)"));
+    if (fileName.isEmpty())
+        return;
+
+    if (ProjectFile::save(fileName, partList->getRootItem()))
+        emit statusUpdateMessage(QString("Saved project: ") + fileName, 0);
+    else
+        QMessageBox::warning(this, tr("Save Project"), tr("Could not write project file %1").arg(fileName));
+}
+
+/**
+ * @brief Shows progress of the background loader in the status bar.
+ * @param done Number of files read so far.
+ * @param total Number of files queued.
+ */
+void MainWindow::updateLoadProgress(int done, int total)
+{
+    loadProgress->setMaximum(total);
+    loadProgress->setValue(done);
+    loadProgress->show();
+    cancelLoadButton->show();
+    emit statusUpdateMessage(QString("Loaded %1 of %2 files").arg(done).arg(total), 0);
+}
+
+/**
+ * @brief Hides the load progress once the background loader is idle.
+ */
+void MainWindow::loadFinished()
+{
+    loadProgress->hide();
+    cancelLoadButton->hide();
+    GeometryCache::flush();
+
+    /* Fit the view once opened files, an imported folder or a project have arrived */
+    if (fitCameraOnLoad) {
+        fitCameraOnLoad = false;
+        resetCamera();
+    }
+}
+
+/* Mark parts whose loads were dropped, they keep any proxy they have */
+static void markNotLoaded(ModelPart* part)
+{
+    if (part->getLoadState() == ModelPart::Loading)
+        part->setLoadState(ModelPart::NotLoaded);
+    for (int i = 0; i < part->childCount(); i++)
+        markNotLoaded(part->child(i));
+}
+
+/**
+ * @brief Cancels any files still waiting to be loaded.
+ *
+ * Parts already in the tree that were waiting for their geometry are marked
+ * as not loaded, Load Missing Parts queues them again.
+ */
+void MainWindow::cancelLoading()
+{
+    loader->cancel();
+    markNotLoaded(partList->getRootItem());
+    emit statusUpdateMessage(QString("Loading cancelled"), 0);
+}
+
+/**
+ * @brief Applies the part changes made so far and renders straight away.
+ *
+ * Only the changed parts are touched, the rest of the scene is left as it is.
+ */
+void MainWindow::updateRender()
+{
+    PartChangeNotifier::instance()->flush();
+    sceneSync->sync();
+    renderWindow->Render();
+}
+
+/**
+ * @brief Brings the render up to date with a batch of part changes.
+ *
+ * Visibility is inherited down the tree and an inserted branch is new
+ * throughout, so both mark the whole subtree. Renaming is left to the
+ * tree view, as is the load state, and LODManager switches levels of
+ * detail itself. Renders once per batch, and only if the scene changed.
+ *
+ * @param changes The parts changed since the last batch and what changed about each.
+ */
+void MainWindow::partsChanged(const PartChangeNotifier::Changes& changes)
+{
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        if (it.value() & (PartChangeNotifier::Visibility | PartChangeNotifier::Inserted))
+            sceneSync->subtreeChanged(it.key());
+        else if (it.value() & ~PartChangeNotifier::Properties(PartChangeNotifier::Name | PartChangeNotifier::LoadState
+                                                              | PartChangeNotifier::LevelsOfDetail))
+            sceneSync->partChanged(it.key());
+
+        if (it.value() & PartChangeNotifier::Geometry)
+            lodManager->partChanged(it.key());
+    }
+
+    /* Changes reach the headset before its next frame */
+    if (vrSync != nullptr && vrThread->isRunning())
+        vrSync->partsChanged(changes);
+
+    if (sceneSync->sync())
+        renderWindow->Render();
+}
+
+/**
+ * @brief Shows a change made to a branch without going through its setters.
+ *
+ * As showPartChange(), for stage edits applied to a whole branch.
+ *
+ * @param part The root of the changed branch.
+ */
+void MainWindow::showSubtreeChange(ModelPart* part)
+{
+    sceneSync->subtreeChanged(part);
+    requestRender();
 }
 
 /**
  * @brief Resets the camera position.
  */
 void MainWindow::resetCamera() {
+    PartChangeNotifier::instance()->flush();
+    sceneSync->sync(); // Fit the scene as it will be drawn
     renderer->ResetCamera(); // Adjust as needed to fit your scene
     renderWindow->Render();
 }
@@ -287,7 +839,8 @@ void MainWindow::startVR()
     if (!vrThread || vrThread->isRunning()) {
 		return; // VR is already running or no instance available
 	}
-    VRActorsFromTree(partList->index(0, 0, QModelIndex()));
+    /* Parts are copied over once, after that only their changes are sent */
+    vrSync->addSubtree(partList->getRootItem());
     vrThread->start();
 }
 
@@ -297,6 +850,8 @@ void MainWindow::on_pushButton_4_clicked() {
     if (vrThread && vrThread->isRunning()) {
         vrThread->issueCommand(VRRenderThread::END_RENDER, 0);
         vrThread->wait(); // Wait for the thread to finish
+        delete vrSync;
+        vrSync = nullptr;
         delete vrThread; // Clean up
         vrThread = nullptr; // Reset pointer
     }
@@ -332,9 +887,7 @@ void MainWindow::on_actionShrink_Filter_triggered()
     QModelIndex index = ui->treeView->currentIndex();
     ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
     selectedPart->shrink(filterFlag);
-    updateRender();
-    renderWindow->Render();
-    resetCamera();
+    filterSubtree(selectedPart);
 }
 
 
@@ -402,56 +955,135 @@ void MainWindow::on_actionClip_Filter_triggered()
 	QModelIndex index = ui->treeView->currentIndex();
 	ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
 	selectedPart->clip(filterFlag);
-	updateRender();
-	renderWindow->Render();
-	resetCamera();
+	filterSubtree(selectedPart);
 }
 
 
-void MainWindow::on_actionEdit_Properties_triggered()
+/**
+ * @brief Switches capping of clipped sections on or off for every part.
+ * @param checked True to close the cut made by the clip filter.
+ */
+void MainWindow::on_actionCap_Clipped_Sections_toggled(bool checked)
 {
-    settingsDialog();
+    QSettings settings;
+    settings.setValue("filters/capClip", checked);
+
+    ModelPart::setDefaultClipCapping(checked);
+    partList->getRootItem()->setClipCapping(checked);
+    filterSubtree(partList->getRootItem());
 }
 
 
-void MainWindow::VRActorsFromTree(const QModelIndex& index)
+/**
+ * @brief Shows the filter settings dialog, with the clip range fitted to the scene.
+ */
+void MainWindow::on_actionFilter_Settings_triggered()
 {
-    if (index.isValid()) {
-        ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
-        selectedPart->set(1, "true");
+    double bounds[6];
+    renderer->ComputeVisiblePropBounds(bounds);
+    filterDialog->setSceneBounds(bounds);
+    filterDialog->show();
+    filterDialog->raise();
+    filterDialog->activateWindow();
+}
 
-        // Check if the ModelPart is visible
-        if (!selectedPart->getVisibility()) {
-            selectedPart->set(1, "false"); // Assuming there is a set() method in ModelPart class
-            return;
-        }
 
-        vtkActor* VRactor = selectedPart->getNewActor(); // Assuming there is a getActor() method in ModelPart class
+/**
+ * @brief Shows the filter stack editor for the selected part.
+ */
+void MainWindow::on_actionFilter_Stack_triggered()
+{
+    QModelIndex index = ui->treeView->currentIndex();
+    filterStackDialog->setPart(index.isValid() ? static_cast<ModelPart*>(index.internalPointer()) : nullptr);
+    filterStackDialog->show();
+    filterStackDialog->raise();
+    filterStackDialog->activateWindow();
+}
 
-        // Check if the actor is not null
-        if (VRactor == nullptr) {
-            if (!partList->hasChildren(index) || (index.flags() & Qt::ItemNeverHasChildren)) {
-                return;
-            }
 
-            // Loop through children and add their actors
-            int rows = partList->rowCount(index);
-            for (int i = 0; i < rows; i++) {
-                VRActorsFromTree(partList->index(i, 0, index));
-            }
-            return;
-        }
+/**
+ * @brief Switches the render-time section view on or off for the whole scene.
+ * @param checked True to cut every part open at the clip plane.
+ */
+void MainWindow::on_actionSection_View_toggled(bool checked)
+{
+    vtkPlane* plane = checked ? sectionPlane.Get() : nullptr;
+    ModelPart::setDefaultSectionPlane(plane);
+    partList->getRootItem()->setSectionPlane(plane);
+}
 
-        // Get the color from the ModelPart and set it to the actor
-        QColor color = selectedPart->getColor(); // Assuming there is a get_Color() method in ModelPart class
-        VRactor->GetProperty()->SetColor(color.redF(), color.greenF(), color.blueF());
-        vrThread->addActorOffline(VRactor);
-    }
+/**
+ * @brief Switches the render-time section view on or off for the selected subtree.
+ */
+void MainWindow::on_actionSection_Selected_Part_triggered()
+{
+    QModelIndex index = ui->treeView->currentIndex();
+    if (!index.isValid())
+        return;
 
-    resetCamera();
-    
+    ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
+    selectedPart->setSectionPlane(selectedPart->getSectionPlane() ? nullptr : sectionPlane.Get());
 }
 
+
+void MainWindow::on_actionEdit_Properties_triggered()
+{
+    settingsDialog();
+}
+
+/**
+ * @brief Asks for the distance within which STL vertices are welded on load.
+ *
+ * Only affects files loaded after the change.
+ */
+void MainWindow::on_actionWeld_Tolerance_triggered()
+{
+    bool ok;
+    double tolerance = QInputDialog::getDouble(this, tr("Weld Tolerance"),
+        tr("Merge STL vertices closer than (0 = identical only):"),
+        ModelPart::getWeldTolerance(), 0.0, 1000.0, 6, &ok);
+    if (!ok)
+        return;
+
+    ModelPart::setWeldTolerance(tolerance);
+    QSettings settings;
+    settings.setValue("import/weldTolerance", tolerance);
+}
+
+/**
+ * @brief Switches progressive loading (proxy first, then full geometry) on or off.
+ * @param checked True to show a coarse proxy while each file loads.
+ */
+void MainWindow::on_actionProgressive_Loading_toggled(bool checked)
+{
+    QSettings settings;
+    settings.setValue("import/progressive", checked);
+}
+
+/**
+ * @brief Switches level of detail rendering on or off.
+ * @param checked False to always draw parts at full resolution.
+ */
+void MainWindow::on_actionLevel_of_Detail_toggled(bool checked)
+{
+    lodManager->setEnabled(checked);
+    QSettings settings;
+    settings.setValue("render/levelOfDetail", checked);
+    renderWindow->Render();
+}
+
+/**
+ * @brief Switches the on-disk geometry cache on or off.
+ * @param checked False to always parse STL files from scratch.
+ */
+void MainWindow::on_actionUse_Geometry_Cache_toggled(bool checked)
+{
+    GeometryCache::setEnabled(checked);
+    QSettings settings;
+    settings.setValue("cache/enabled", checked);
+}
+
+
 // Stop 
 // 
 // VTK Actor has functional visibility but not the VR actor?
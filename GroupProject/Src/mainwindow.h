@@ -6,6 +6,20 @@
 #include <vtkRenderer.h>
 #include <vtkGenericOpenGLRenderWindow.h>
 #include "VRRenderThread.h"
+#include "STLLoader.h"
+#include "FilterRunner.h"
+#include "filterdialog.h"
+#include "filterstackdialog.h"
+#include "SceneSync.h"
+#include "LODManager.h"
+#include "VRSceneSync.h"
+#include "PartChangeNotifier.h"
+#include <QProgressBar>
+#include <QPushButton>
+#include <vtkPlane.h>
+#include <QSet>
+#include <QFileSystemWatcher>
+#include <QTimer>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -21,11 +35,15 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
     void updateRender();
-    void updateRenderFromTree(const QModelIndex& index);
-    void VRActorsFromTree(const QModelIndex& index);
     void resetCamera();
     void loadStlFile(const QString& fileName);  
-    void update_name();
+    void loadPartGeometry(ModelPart* part, bool withProxy);
+    void showPartChange(ModelPart* part);
+    void showSubtreeChange(ModelPart* part);
+    void requestRender();
+    void filterPart(ModelPart* part, bool interactive = false);
+    void filterSubtree(ModelPart* part, bool interactive = false);
+    void watchFile(const QString& fileName);
     
 public slots:
     void settingsDialog();
@@ -36,12 +54,24 @@ public slots:
     void on_pushButton_4_clicked();
     void on_pushButton_5_clicked();
     void on_pushButton_6_clicked();
+    void updateLoadProgress(int done, int total);
+    void loadFinished();
+    void cancelLoading();
+    void setShrinkFactor(double factor);
+    void setClipPlane(const double origin[3], const double normal[3]);
+    void fileChanged(const QString& fileName);
+    void reloadChangedFiles();
+    void partsChanged(const PartChangeNotifier::Changes& changes);
 
 signals:
     void statusUpdateMessage(const QString & message, int timeout);
 
 private slots:
     void on_actionOpen_File_triggered();
+    void on_actionOpen_Project_triggered();
+    void on_actionLoad_Missing_Parts_triggered();
+    void on_actionImport_Folder_triggered();
+    void on_actionSave_Project_triggered();
     void on_actionItem_Options_triggered();
     void on_actionSave_Screenshot_triggered();
     void on_actionStart_VR_triggered();
@@ -50,8 +80,17 @@ private slots:
     void on_actionChange_App_Color_triggered();
     void on_actionHow_to_Use_triggered();
     void on_actionClip_Filter_triggered();
+    void on_actionCap_Clipped_Sections_toggled(bool checked);
+    void on_actionSection_View_toggled(bool checked);
+    void on_actionSection_Selected_Part_triggered();
     void on_actionShrink_Filter_triggered();
     void on_actionEdit_Properties_triggered();
+    void on_actionWeld_Tolerance_triggered();
+    void on_actionFilter_Settings_triggered();
+    void on_actionFilter_Stack_triggered();
+    void on_actionUse_Geometry_Cache_toggled(bool checked);
+    void on_actionProgressive_Loading_toggled(bool checked);
+    void on_actionLevel_of_Detail_toggled(bool checked);
 
 private:
     Ui::MainWindow *ui;
@@ -59,6 +98,21 @@ private:
     vtkSmartPointer<vtkRenderer> renderer;
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> renderWindow;
     VRRenderThread* vrThread = nullptr;
+    VRSceneSync* vrSync = nullptr;      /**< Sends part changes to the running VR session */
+    STLLoader* loader;
+    FilterRunner* filterRunner;
+    FilterDialog* filterDialog;
+    FilterStackDialog* filterStackDialog;
+    QProgressBar* loadProgress;
+    QPushButton* cancelLoadButton;
+    bool renderPending = false;
+    QFileSystemWatcher* fileWatcher;
+    QTimer* reloadTimer;
+    QSet<QString> changedFiles;
+    SceneSync* sceneSync;
+    LODManager* lodManager;     /**< Draws parts that are small on screen with fewer triangles */
+    bool fitCameraOnLoad = false;      /**< Reset the camera when the current loads finish */
+    vtkSmartPointer<vtkPlane> sectionPlane;
 
 };
 #endif // MAINWINDOW_H
@@ -17,9 +17,6 @@ OptionDialog::OptionDialog(QWidget *parent)
     connect(ui->checkBox, &QCheckBox::stateChanged, this, &OptionDialog::updateModelPartVisibility);
     connect(ui->pushButton, &QPushButton::released, this, &OptionDialog::updateModelPartColor);
     connect(ui->buttonBox, &QDialogButtonBox::accepted, this, &OptionDialog::saveSettings);
-    connect(this, &OptionDialog::settingsSaved, static_cast<MainWindow*>(parent), &MainWindow::updateRender);
-    connect(this, &OptionDialog::settingsSaved, static_cast<MainWindow*>(parent), &MainWindow::update_name);
-    //connect(this, &OptionDialog::settingsSaved, static_cast<MainWindow*>(parent), &MainWindow::updateVRthread);
 
 }
 
@@ -43,7 +40,6 @@ void OptionDialog::saveSettings(){
     ptr -> setColour(Colour);
     ptr -> setVisible(ui->checkBox->isChecked());
     ptr -> setName(ui->lineEdit->text());
-    emit settingsSaved();
 }
 
 
@@ -28,9 +28,6 @@ public slots:
     void updateModelPartVisibility(int state);
     void saveSettings();
     void loadSettings();
-signals:
-
-    void settingsSaved();
 
 private:
     Ui::OptionDialog *ui;
@@ -0,0 +1,108 @@
+/**     @file bench_surfaceclipper.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Times SurfaceClipper against the vtkClipDataSet and vtkGeometryFilter
+  *     pipeline it replaces on a large mesh, and checks both cut the same
+  *     surface. Run with -iterations n for steadier timings.
+  */
+
+#include "SurfaceClipper.h"
+
+#include <QtTest>
+#include <vtkClipDataSet.h>
+#include <vtkGeometryFilter.h>
+#include <vtkMassProperties.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkSphereSource.h>
+#include <vtkTriangleFilter.h>
+
+class BenchSurfaceClipper : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void sameSurface();
+    void clip_data();
+    void clip();
+
+private:
+    vtkSmartPointer<vtkPolyData> mesh;
+};
+
+/* About two million triangles, with the normals the sphere source makes */
+static const int sphereResolution = 1000;
+
+static const double origin[3] = { 0.1, 0.2, 0.0 };
+static const double normal[3] = { 0.3, 1.0, 0.2 };
+
+/* The pipeline ClipStage used before SurfaceClipper */
+static vtkSmartPointer<vtkPolyData> clipWithVTK(vtkPolyData* input) {
+    vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(origin[0], origin[1], origin[2]);
+    plane->SetNormal(normal[0], normal[1], normal[2]);
+
+    vtkSmartPointer<vtkClipDataSet> clipFilter = vtkSmartPointer<vtkClipDataSet>::New();
+    clipFilter->SetInputData(input);
+    clipFilter->SetClipFunction(plane);
+
+    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
+    geometryFilter->SetInputConnection(clipFilter->GetOutputPort());
+    geometryFilter->Update();
+
+    vtkSmartPointer<vtkPolyData> output = geometryFilter->GetOutput();
+    return output;
+}
+
+static double area(vtkPolyData* surface) {
+    vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+    triangleFilter->SetInputData(surface);
+
+    vtkSmartPointer<vtkMassProperties> mass = vtkSmartPointer<vtkMassProperties>::New();
+    mass->SetInputConnection(triangleFilter->GetOutputPort());
+    mass->Update();
+    return mass->GetSurfaceArea();
+}
+
+void BenchSurfaceClipper::initTestCase() {
+    vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+    sphere->SetThetaResolution(sphereResolution);
+    sphere->SetPhiResolution(sphereResolution);
+    sphere->Update();
+    mesh = sphere->GetOutput();
+    QVERIFY(mesh->GetPointData()->GetNormals() != nullptr);
+    qInfo() << "Clipping" << mesh->GetNumberOfPolys() << "triangles";
+}
+
+/* Both cut the same surface, and the normals made before clipping survive it */
+void BenchSurfaceClipper::sameSurface() {
+    vtkSmartPointer<vtkPolyData> ours = SurfaceClipper::clip(mesh, origin, normal, false);
+    vtkSmartPointer<vtkPolyData> theirs = clipWithVTK(mesh);
+
+    double ourArea = area(ours), theirArea = area(theirs);
+    QVERIFY2(qAbs(ourArea - theirArea) <= 1e-9 * theirArea,
+             qPrintable(QString("area %1, expected %2").arg(ourArea, 0, 'g', 17).arg(theirArea, 0, 'g', 17)));
+
+    vtkDataArray* normals = ours->GetPointData()->GetNormals();
+    QVERIFY(normals != nullptr);
+    QCOMPARE(normals->GetNumberOfTuples(), ours->GetNumberOfPoints());
+}
+
+void BenchSurfaceClipper::clip_data() {
+    QTest::addColumn<bool>("surfaceClipper");
+    QTest::newRow("SurfaceClipper") << true;
+    QTest::newRow("vtkClipDataSet + vtkGeometryFilter") << false;
+}
+
+void BenchSurfaceClipper::clip() {
+    QFETCH(bool, surfaceClipper);
+    vtkSmartPointer<vtkPolyData> output;
+    QBENCHMARK {
+        output = surfaceClipper ? SurfaceClipper::clip(mesh, origin, normal, false) : clipWithVTK(mesh);
+    }
+    QVERIFY(output->GetNumberOfPolys() > 0);
+}
+
+QTEST_GUILESS_MAIN(BenchSurfaceClipper)
+#include "bench_surfaceclipper.moc"
@@ -0,0 +1,120 @@
+/**     @file bench_surfaceshrinker.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Times SurfaceShrinker against the vtkShrinkFilter and vtkGeometryFilter
+  *     pipeline it replaces on a large mesh, with 1, 4, 16 and 32 threads,
+  *     and checks both give the same points. Run with -iterations n for
+  *     steadier timings.
+  */
+
+#include "SurfaceShrinker.h"
+
+#include <QtTest>
+#include <vtkGeometryFilter.h>
+#include <vtkSMPTools.h>
+#include <vtkShrinkFilter.h>
+#include <vtkSphereSource.h>
+
+class BenchSurfaceShrinker : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void samePoints();
+    void shrink_data();
+    void shrink();
+    void cleanupTestCase();
+
+private:
+    vtkSmartPointer<vtkPolyData> mesh;
+};
+
+/* About two million triangles */
+static const int sphereResolution = 1000;
+
+static const double factor = 0.5;
+
+/* The pipeline ShrinkStage used before SurfaceShrinker */
+static vtkSmartPointer<vtkPolyData> shrinkWithVTK(vtkPolyData* input) {
+    vtkSmartPointer<vtkShrinkFilter> shrinkFilter = vtkSmartPointer<vtkShrinkFilter>::New();
+    shrinkFilter->SetInputData(input);
+    shrinkFilter->SetShrinkFactor(factor);
+
+    vtkSmartPointer<vtkGeometryFilter> geometryFilter = vtkSmartPointer<vtkGeometryFilter>::New();
+    geometryFilter->SetInputConnection(shrinkFilter->GetOutputPort());
+    geometryFilter->Update();
+
+    vtkSmartPointer<vtkPolyData> output = geometryFilter->GetOutput();
+    return output;
+}
+
+void BenchSurfaceShrinker::initTestCase() {
+    vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+    sphere->SetThetaResolution(sphereResolution);
+    sphere->SetPhiResolution(sphereResolution);
+    sphere->Update();
+    mesh = sphere->GetOutput();
+    qInfo() << "Shrinking" << mesh->GetNumberOfPolys() << "triangles";
+}
+
+/* Every triangle's corners end up in the same place, to rounding */
+void BenchSurfaceShrinker::samePoints() {
+    vtkSmartPointer<vtkPolyData> ours = SurfaceShrinker::shrink(mesh, factor);
+    vtkSmartPointer<vtkPolyData> theirs = shrinkWithVTK(mesh);
+    QCOMPARE(ours->GetNumberOfPolys(), theirs->GetNumberOfPolys());
+
+    for (vtkIdType t = 0; t < ours->GetNumberOfPolys(); t++) {
+        vtkIdType count, theirCount;
+        const vtkIdType* ids;
+        const vtkIdType* theirIds;
+        ours->GetCellPoints(t, count, ids);
+        theirs->GetCellPoints(t, theirCount, theirIds);
+        QCOMPARE(count, theirCount);
+
+        for (vtkIdType corner = 0; corner < count; corner++) {
+            double a[3], e[3];
+            ours->GetPoint(ids[corner], a);
+            theirs->GetPoint(theirIds[corner], e);
+            for (int c = 0; c < 3; c++) {
+                if (qAbs(a[c] - e[c]) > 1e-6)
+                    QFAIL(qPrintable(QString("triangle %1 corner %2 is %3, expected %4").arg(t).arg(corner).arg(a[c]).arg(e[c])));
+            }
+        }
+    }
+}
+
+void BenchSurfaceShrinker::shrink_data() {
+    QTest::addColumn<bool>("surfaceShrinker");
+    QTest::addColumn<int>("threads");
+    for (int threads : { 1, 4, 16, 32 }) {
+        QTest::addRow("SurfaceShrinker, %d threads", threads) << true << threads;
+        QTest::addRow("vtkShrinkFilter + vtkGeometryFilter, %d threads", threads) << false << threads;
+    }
+}
+
+void BenchSurfaceShrinker::shrink() {
+    QFETCH(bool, surfaceShrinker);
+    QFETCH(int, threads);
+    vtkSMPTools::Initialize(threads);
+
+    /* The Sequential backend, or one that ignores being initialised again,
+     * would time the same thing under every label */
+    int actual = vtkSMPTools::GetEstimatedNumberOfThreads();
+    if (actual != threads)
+        QSKIP(qPrintable(QString("The SMP backend runs %1 threads, not %2").arg(actual).arg(threads)));
+
+    vtkSmartPointer<vtkPolyData> output;
+    QBENCHMARK {
+        output = surfaceShrinker ? SurfaceShrinker::shrink(mesh, factor) : shrinkWithVTK(mesh);
+    }
+    QCOMPARE(output->GetNumberOfPolys(), mesh->GetNumberOfPolys());
+}
+
+/* Back to the default, one thread per core */
+void BenchSurfaceShrinker::cleanupTestCase() {
+    vtkSMPTools::Initialize(0);
+}
+
+QTEST_GUILESS_MAIN(BenchSurfaceShrinker)
+#include "bench_surfaceshrinker.moc"
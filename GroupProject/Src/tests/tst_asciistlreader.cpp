@@ -0,0 +1,160 @@
+/**     @file tst_asciistlreader.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Checks that AsciiSTLReader gives exactly the geometry vtkSTLReader
+  *     does, however the file is split into chunks.
+  */
+
+#include "AsciiSTLReader.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+#include <vtkSTLReader.h>
+
+class TestAsciiSTLReader : public QObject {
+    Q_OBJECT
+
+private slots:
+    void multipleSolids();
+    void crlfLineEndings();
+    void exponentFloats();
+    void chunkBoundariesMidFacet();
+
+private:
+    /** Write a fixture to the temporary directory
+      * @return the file name
+      */
+    QString write(const QString& name, const QByteArray& text);
+
+    /** Read a file with both readers and check every triangle has the same
+      * corners in the same order, for each number of chunks given */
+    void compare(const QString& fileName, vtkIdType triangles, const QList<int>& chunkCounts);
+
+    QTemporaryDir dir;
+};
+
+/* One facet, each vertex given as its three numbers exactly as written to the file */
+static QByteArray facet(const QByteArrayList& vertices, const char* newline = "\n") {
+    QByteArray text;
+    text += "  facet normal 0 0 1"; text += newline;
+    text += "    outer loop"; text += newline;
+    for (const QByteArray& vertex : vertices) {
+        text += "      vertex " + vertex; text += newline;
+    }
+    text += "    endloop"; text += newline;
+    text += "  endfacet"; text += newline;
+    return text;
+}
+
+/* Coordinates that do not repeat, written with up to 9 significant digits */
+static QByteArray vertex(int i) {
+    quint32 state = quint32(i) * 2654435761u + 12345u;
+    QByteArray numbers;
+    for (int c = 0; c < 3; c++) {
+        state = state * 1664525u + 1013904223u;
+        double value = (double(state % 2000000u) - 1000000.0) / 997.0;
+        numbers += QByteArray::number(value, 'g', 9) + (c < 2 ? " " : "");
+    }
+    return numbers;
+}
+
+QString TestAsciiSTLReader::write(const QString& name, const QByteArray& text) {
+    QString fileName = dir.filePath(name);
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return QString();
+    file.write(text);
+    return fileName;
+}
+
+void TestAsciiSTLReader::compare(const QString& fileName, vtkIdType triangles, const QList<int>& chunkCounts) {
+    QVERIFY(!fileName.isEmpty());
+
+    /* Without merging vtkSTLReader also gives every corner its own point, in file order */
+    vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
+    reader->SetFileName(fileName.toLocal8Bit().constData());
+    reader->MergingOff();
+    reader->Update();
+    vtkPolyData* expected = reader->GetOutput();
+    QCOMPARE(expected->GetNumberOfPolys(), triangles);
+
+    for (int chunks : chunkCounts) {
+        vtkSmartPointer<vtkPolyData> actual = AsciiSTLReader::read(fileName, chunks);
+        QVERIFY2(actual != nullptr, qPrintable(QString("%1 chunks").arg(chunks)));
+        QCOMPARE(actual->GetNumberOfPoints(), expected->GetNumberOfPoints());
+        QCOMPARE(actual->GetNumberOfPolys(), triangles);
+
+        for (vtkIdType t = 0; t < triangles; t++) {
+            vtkIdType count, expectedCount;
+            const vtkIdType* ids;
+            const vtkIdType* expectedIds;
+            actual->GetCellPoints(t, count, ids);
+            expected->GetCellPoints(t, expectedCount, expectedIds);
+            QCOMPARE(count, vtkIdType(3));
+            QCOMPARE(expectedCount, vtkIdType(3));
+
+            for (int corner = 0; corner < 3; corner++) {
+                double a[3], e[3];
+                actual->GetPoint(ids[corner], a);
+                expected->GetPoint(expectedIds[corner], e);
+                for (int c = 0; c < 3; c++) {
+                    if (a[c] != e[c])
+                        QFAIL(qPrintable(QString("%1 chunks: triangle %2 corner %3 is %4, expected %5")
+                                         .arg(chunks).arg(t).arg(corner).arg(a[c], 0, 'g', 17).arg(e[c], 0, 'g', 17)));
+                }
+            }
+        }
+    }
+}
+
+void TestAsciiSTLReader::multipleSolids() {
+    QVERIFY(dir.isValid());
+    QByteArray text;
+    int v = 0;
+    for (int solid = 0; solid < 3; solid++) {
+        text += "solid part " + QByteArray::number(solid) + " of assembly\n";
+        for (int f = 0; f < 4; f++, v += 3)
+            text += facet({ vertex(v), vertex(v + 1), vertex(v + 2) });
+        text += "endsolid part " + QByteArray::number(solid) + " of assembly\n";
+    }
+    compare(write("multi.stl", text), 12, { 0, 1, 2, 3, 5 });
+}
+
+void TestAsciiSTLReader::crlfLineEndings() {
+    QVERIFY(dir.isValid());
+    QByteArray text = "solid crlf\r\n";
+    for (int f = 0; f < 20; f++)
+        text += facet({ vertex(3 * f), vertex(3 * f + 1), vertex(3 * f + 2) }, "\r\n");
+    text += "endsolid crlf\r\n";
+    compare(write("crlf.stl", text), 20, { 0, 1, 3, 7 });
+}
+
+void TestAsciiSTLReader::exponentFloats() {
+    QVERIFY(dir.isValid());
+    QByteArray text = "solid exponents\n";
+    text += facet({ "1.5e+02 -3.25E-1 7e0", "+2.5 1e-7 -0.0", "6.02214076e23 -1.25E+2 3E-05" });
+    text += facet({ "1e1 1E1 1.e1", "-9.999999e-38 4.2e+00 .5", "0.000001 -1234567.8 12345e-3" });
+    text += "endsolid exponents\n";
+    compare(write("exponents.stl", text), 2, { 0, 1, 2 });
+}
+
+/* With this many chunks over a few hundred facets the evenly spaced split
+ * points land inside facets, inside keywords and inside numbers */
+void TestAsciiSTLReader::chunkBoundariesMidFacet() {
+    QVERIFY(dir.isValid());
+    QByteArray text = "solid chunks\n";
+    const int facets = 500;
+    for (int f = 0; f < facets; f++)
+        text += facet({ vertex(3 * f), vertex(3 * f + 1), vertex(3 * f + 2) });
+    text += "endsolid chunks\n";
+
+    QList<int> chunkCounts;
+    for (int chunks = 1; chunks <= 64; chunks++)
+        chunkCounts.append(chunks);
+    chunkCounts.append(997);
+    compare(write("chunks.stl", text), facets, chunkCounts);
+}
+
+QTEST_GUILESS_MAIN(TestAsciiSTLReader)
+#include "tst_asciistlreader.moc"
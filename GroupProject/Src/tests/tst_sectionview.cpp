@@ -0,0 +1,135 @@
+/**     @file tst_sectionview.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Renders a sectioned part with software OpenGL, in an offscreen window
+  *     as the desktop view does and through OffscreenVRBackend as VR does,
+  *     and checks that the side of the part that is cut away is not drawn,
+  *     including after the plane has been moved.
+  */
+
+#include "ModelPart.h"
+#include "OffscreenVRBackend.h"
+#include "PartChangeNotifier.h"
+#include "VRRenderThread.h"
+#include "VRSceneSync.h"
+
+#include <QtTest>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkImageData.h>
+#include <vtkPlane.h>
+#include <vtkPoints.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkWindowToImageFilter.h>
+
+class TestSectionView : public QObject {
+    Q_OBJECT
+
+private slots:
+    void cutSideNotDrawn();
+};
+
+/* Enough frames for the queued section change to be applied and drawn */
+static const int frameLimit = 5;
+
+static const unsigned long timeoutMilliseconds = 2 * 60 * 1000;
+
+/* A white square two units across in the XZ plane, facing -Y. The VR thread
+ * turns parts -90 degrees about X, which leaves it facing its camera. */
+static vtkSmartPointer<vtkPolyData> square() {
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->InsertNextPoint(-1.0, 0.0, -1.0);
+    points->InsertNextPoint(1.0, 0.0, -1.0);
+    points->InsertNextPoint(1.0, 0.0, 1.0);
+    points->InsertNextPoint(-1.0, 0.0, 1.0);
+
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    const vtkIdType first[3] = { 0, 1, 2 };
+    const vtkIdType second[3] = { 0, 2, 3 };
+    polys->InsertNextCell(3, first);
+    polys->InsertNextCell(3, second);
+
+    vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+    data->SetPoints(points);
+    data->SetPolys(polys);
+    return data;
+}
+
+/* Whether the square is drawn at a pixel, it is white and both backgrounds are dark */
+static bool drawnAt(vtkRenderWindow* window, int x, int y) {
+    vtkSmartPointer<vtkWindowToImageFilter> grab = vtkSmartPointer<vtkWindowToImageFilter>::New();
+    grab->SetInput(window);
+    grab->ReadFrontBufferOff();
+    grab->Update();
+    const unsigned char* pixel = static_cast<const unsigned char*>(grab->GetOutput()->GetScalarPointer(x, y, 0));
+    return pixel[0] > 128;
+}
+
+void TestSectionView::cutSideNotDrawn() {
+    /* The plane keeps x >= 0, the right hand half of the square */
+    vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(0.0, 0.0, 0.0);
+    plane->SetNormal(1.0, 0.0, 0.0);
+
+    ModelPart root({ "Part" });
+    ModelPart* part = new ModelPart({ "square", true }, &root);
+    root.appendChild(part);
+    part->setGeometry(square());
+    part->setColour(QColor(255, 255, 255));
+    part->getActor()->GetProperty()->SetColor(1.0, 1.0, 1.0);
+    part->setSectionPlane(plane);
+
+    /* Desktop: looking along +Y with +X to the right, the square fills the middle */
+    vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+    renderer->AddActor(part->getActor());
+    renderer->GetActiveCamera()->SetPosition(0.0, -5.0, 0.0);
+    renderer->GetActiveCamera()->SetFocalPoint(0.0, 0.0, 0.0);
+    renderer->GetActiveCamera()->SetViewUp(0.0, 0.0, 1.0);
+    renderer->ResetCamera();
+
+    vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+    window->SetOffScreenRendering(1);
+    window->SetSize(200, 200);
+    window->AddRenderer(renderer);
+    window->Render();
+    QVERIFY2(!drawnAt(window, 60, 100), "Desktop: the cut away half is drawn");
+    QVERIFY2(drawnAt(window, 140, 100), "Desktop: the kept half is not drawn");
+
+    /* VR: the part's actor is made with a copy of the plane as it is now */
+    std::unique_ptr<OffscreenVRBackend> backend = std::make_unique<OffscreenVRBackend>(frameLimit, false);
+    OffscreenVRBackend* offscreen = backend.get();
+    VRRenderThread thread(nullptr, std::move(backend));
+    VRSceneSync vrSync(&thread);
+    vrSync.addSubtree(&root);
+
+    /* Turn the plane round in place, as dragging it does, so the left half is kept.
+     * The VR copy only follows if the move is reported and forwarded. */
+    QObject context;
+    connect(PartChangeNotifier::instance(), &PartChangeNotifier::partsChanged, &context,
+            [&vrSync](const PartChangeNotifier::Changes& changes) { vrSync.partsChanged(changes); });
+    plane->SetNormal(-1.0, 0.0, 0.0);
+    ModelPart::sectionPlaneMoved(plane);
+    PartChangeNotifier::instance()->flush();
+
+    window->Render();
+    QVERIFY2(drawnAt(window, 60, 100), "Desktop: the kept half is not drawn after the move");
+    QVERIFY2(!drawnAt(window, 140, 100), "Desktop: the cut away half is drawn after the move");
+
+    thread.start();
+    QVERIFY2(thread.wait(timeoutMilliseconds), "The VR thread did not reach its frame limit in time");
+    QCOMPARE(offscreen->frameCount(), frameLimit);
+
+    /* The left eye fills the left half of the buffer, sample either side of its middle */
+    vtkRenderWindow* vrWindow = offscreen->getRenderWindow();
+    int* size = vrWindow->GetSize();
+    int eyeMiddle = size[0] / 4;
+    int offset = size[0] / 16;
+    QVERIFY2(drawnAt(vrWindow, eyeMiddle - offset, size[1] / 2), "VR: the kept half is not drawn");
+    QVERIFY2(!drawnAt(vrWindow, eyeMiddle + offset, size[1] / 2), "VR: the cut away half is drawn");
+}
+
+QTEST_GUILESS_MAIN(TestSectionView)
+#include "tst_sectionview.moc"
@@ -0,0 +1,119 @@
+/**     @file tst_vertexwelder.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Checks that VertexWelder merges exactly the points within its
+  *     tolerance, wherever the grid cell boundaries fall.
+  */
+
+#include "VertexWelder.h"
+#include "TriangleSoup.h"
+
+#include <QtTest>
+#include <vtkFloatArray.h>
+#include <vtkMath.h>
+
+#include <cmath>
+#include <vector>
+
+class TestVertexWelder : public QObject {
+    Q_OBJECT
+
+private slots:
+    void exactMatch();
+    void acrossCellBoundary();
+    void sameCellTooFarApart();
+    void everyPointWithinTolerance();
+};
+
+/* Triangles from a flat list of corner coordinates */
+static vtkSmartPointer<vtkPolyData> soup(const std::vector<float>& corners) {
+    vtkSmartPointer<vtkFloatArray> coords = vtkSmartPointer<vtkFloatArray>::New();
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(vtkIdType(corners.size() / 3));
+    std::copy(corners.begin(), corners.end(), coords->GetPointer(0));
+    return TriangleSoup::build(coords);
+}
+
+void TestVertexWelder::exactMatch() {
+    vtkSmartPointer<vtkPolyData> input = soup({ 0, 0, 0,  1, 0, 0,  0, 1, 0,
+                                                1, 0, 0,  0, 1, 0,  1, 1, 0.000001f });
+    vtkSmartPointer<vtkPolyData> welded = VertexWelder::weld(input, 0.0);
+    QCOMPARE(welded->GetNumberOfPoints(), vtkIdType(4));
+    QCOMPARE(welded->GetNumberOfPolys(), vtkIdType(2));
+}
+
+/* 0.5 is a cell boundary for a tolerance of 0.25, the two corners either
+ * side of it are 2e-6 apart and must still be merged */
+void TestVertexWelder::acrossCellBoundary() {
+    vtkSmartPointer<vtkPolyData> input = soup({ 0.5f - 1e-6f, 0, 0,  2, 0, 0,  2, 2, 0,
+                                                0.5f + 1e-6f, 0, 0,  3, 0, 0,  3, 3, 0 });
+    vtkSmartPointer<vtkPolyData> welded = VertexWelder::weld(input, 0.25);
+    QCOMPARE(welded->GetNumberOfPoints(), vtkIdType(5));
+
+    /* The first point in input order is kept */
+    double p[3];
+    welded->GetPoint(0, p);
+    QCOMPARE(p[0], double(0.5f - 1e-6f));
+}
+
+/* Both corners are in the cell [0, 0.25) but further apart than the tolerance */
+void TestVertexWelder::sameCellTooFarApart() {
+    vtkSmartPointer<vtkPolyData> input = soup({ 0.01f, 0.01f, 0.01f,  2, 0, 0,  2, 2, 0,
+                                                0.24f, 0.24f, 0.24f,  3, 0, 0,  3, 3, 0 });
+    vtkSmartPointer<vtkPolyData> welded = VertexWelder::weld(input, 0.25);
+    QCOMPARE(welded->GetNumberOfPoints(), vtkIdType(6));
+}
+
+/* Clusters of jittered points: every corner must end up within tolerance of
+ * the point it was merged into, and no two kept points may be within tolerance */
+void TestVertexWelder::everyPointWithinTolerance() {
+    const double tolerance = 0.1;
+    std::vector<float> corners;
+    quint32 state = 1;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return double(state >> 8) / double(1u << 24);
+    };
+    for (int t = 0; t < 3000; t++) {
+        for (int c = 0; c < 9; c++)
+            corners.push_back(float(std::floor(next() * 6.0) * 0.3 + next() * 0.08));
+    }
+
+    vtkSmartPointer<vtkPolyData> input = soup(corners);
+    vtkSmartPointer<vtkPolyData> welded = VertexWelder::weld(input, tolerance);
+    QVERIFY(welded->GetNumberOfPoints() < input->GetNumberOfPoints());
+
+    for (vtkIdType a = 0; a < welded->GetNumberOfPoints(); a++) {
+        double p[3], q[3];
+        welded->GetPoint(a, p);
+        for (vtkIdType b = a + 1; b < welded->GetNumberOfPoints(); b++) {
+            welded->GetPoint(b, q);
+            QVERIFY(vtkMath::Distance2BetweenPoints(p, q) > tolerance * tolerance);
+        }
+    }
+
+    /* Collapsed triangles are dropped, so only check those that are left by
+     * matching each one back to its input triangle in order */
+    vtkIdType t = 0;
+    for (vtkIdType w = 0; w < welded->GetNumberOfPolys(); w++) {
+        vtkIdType count;
+        const vtkIdType* ids;
+        welded->GetCellPoints(w, count, ids);
+
+        bool matched = false;
+        for (; t < input->GetNumberOfPolys() && !matched; t++) {
+            matched = true;
+            for (int c = 0; c < 3 && matched; c++) {
+                double p[3], q[3];
+                input->GetPoint(3 * t + c, p);
+                welded->GetPoint(ids[c], q);
+                matched = vtkMath::Distance2BetweenPoints(p, q) <= tolerance * tolerance;
+            }
+        }
+        QVERIFY(matched);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestVertexWelder)
+#include "tst_vertexwelder.moc"
@@ -0,0 +1,83 @@
+/**     @file tst_vrheadless.cpp
+  *
+  *     EEEE2076 - Software Engineering & VR Project
+  *
+  *     Runs the VR thread to completion on the offscreen backend with a
+  *     model loaded, as CI does without a headset. Configure with
+  *     -DENABLE_OPENVR=OFF there, this test never needs OpenVR. It needs an
+  *     OpenGL context, software OpenGL will do.
+  */
+
+#include "AsciiSTLReader.h"
+#include "LODBuilder.h"
+#include "OffscreenVRBackend.h"
+#include "VRRenderThread.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+#include <vtkActor.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkSTLWriter.h>
+#include <vtkSphereSource.h>
+
+#include <atomic>
+
+class TestVRHeadless : public QObject {
+    Q_OBJECT
+
+private slots:
+    void runsToFrameLimit();
+};
+
+/* More than one log period of the offscreen backend */
+static const int frameLimit = 120;
+
+/* Software OpenGL draws both eyes slowly, this is well beyond what it needs */
+static const unsigned long timeoutMilliseconds = 5 * 60 * 1000;
+
+void TestVRHeadless::runsToFrameLimit() {
+    /* Load the model the way the viewer does, from an ASCII STL file */
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString fileName = dir.filePath("sphere.stl");
+
+    vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+    sphere->SetRadius(50.0);
+    sphere->SetThetaResolution(200);
+    sphere->SetPhiResolution(200);
+
+    vtkSmartPointer<vtkSTLWriter> writer = vtkSmartPointer<vtkSTLWriter>::New();
+    writer->SetInputConnection(sphere->GetOutputPort());
+    writer->SetFileName(fileName.toLocal8Bit().constData());
+    writer->SetFileTypeToASCII();
+    QVERIFY(writer->Write() == 1);
+
+    vtkSmartPointer<vtkPolyData> model = AsciiSTLReader::read(fileName);
+    QVERIFY(model != nullptr);
+    QVERIFY(model->GetNumberOfPolys() > 0);
+
+    std::atomic<bool> cancelled(false);
+    QList<vtkSmartPointer<vtkPolyData>> levels = LODBuilder::build(model, 1000, cancelled);
+
+    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(model);
+    vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+
+    /* The thread owns the backend, it lives as long as the thread does */
+    std::unique_ptr<OffscreenVRBackend> backend = std::make_unique<OffscreenVRBackend>(frameLimit);
+    OffscreenVRBackend* offscreen = backend.get();
+    VRRenderThread thread(nullptr, std::move(backend));
+    thread.addActorOffline(actor, levels);
+
+    thread.start();
+    QVERIFY2(thread.wait(timeoutMilliseconds), "The VR thread did not reach its frame limit in time");
+
+    qInfo() << "Mean frame" << offscreen->meanMilliseconds() << "ms, worst" << offscreen->worstMilliseconds() << "ms";
+    QCOMPARE(offscreen->frameCount(), frameLimit);
+    QVERIFY(offscreen->meanMilliseconds() > 0.0);
+    QVERIFY(offscreen->worstMilliseconds() >= offscreen->meanMilliseconds());
+}
+
+QTEST_GUILESS_MAIN(TestVRHeadless)
+#include "tst_vrheadless.moc"